@@ -0,0 +1,64 @@
+#include "async_log.h"
+
+#include <util/generic/yexception.h>
+#include <util/stream/file.h>
+#include <util/system/file.h>
+
+#include <unistd.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+constexpr TDuration FLUSH_PERIOD = TDuration::MilliSeconds(100);
+
+}  // anonymous namespace
+
+TAsyncLogWriter::TAsyncLogWriter(IOutputStream& output)
+    : Output(output)
+{
+    Writer = MakeHolder<TThread>([this]() {
+        TThread::SetCurrentThreadName("kqprun-log");
+        do {
+            Flush();
+        } while (!WriterStopped.WaitT(FLUSH_PERIOD));
+        Flush();
+    });
+    Writer->Start();
+}
+
+TAsyncLogWriter::~TAsyncLogWriter() {
+    WriterStopped.Signal();
+    Writer->Join();
+}
+
+void TAsyncLogWriter::Write(const TRecord& record) {
+    TGuard<TMutex> guard(Mutex);
+    Records.emplace_back(record);
+}
+
+void TAsyncLogWriter::Flush() {
+    with_lock (Mutex) {
+        Records.swap(WrittenRecords);
+    }
+    if (WrittenRecords.empty()) {
+        return;
+    }
+
+    for (const auto& record : WrittenRecords) {
+        Output << record.Time.ToIsoStringLocal() << ' ' << record.Message << ' ' << record.QueryIndex << ", loop " << record.Loop << '\n';
+    }
+    Output.Flush();
+    WrittenRecords.clear();
+}
+
+THolder<IOutputStream> MakeStdoutLogOutput() {
+    const int fd = dup(STDOUT_FILENO);
+    if (fd < 0) {
+        ythrow TSystemError() << "Failed to duplicate stdout for async log";
+    }
+    return MakeHolder<TFileOutput>(TFile(fd));
+}
+
+}  // namespace NKqpRun
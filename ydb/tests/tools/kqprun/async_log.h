@@ -0,0 +1,51 @@
+#pragma once
+
+#include <util/datetime/base.h>
+#include <util/generic/ptr.h>
+#include <util/stream/output.h>
+#include <util/system/event.h>
+#include <util/system/mutex.h>
+#include <util/system/thread.h>
+
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Log of kqprun measured loop for high rate runs, records are formatted and written by background thread,
+// so loop step spends only time of pushing record into queue
+class TAsyncLogWriter {
+public:
+    struct TRecord {
+        TInstant Time;
+        // Should be string literal, it is not copied
+        const char* Message = nullptr;
+        size_t QueryIndex = 0;
+        size_t Loop = 0;
+    };
+
+    explicit TAsyncLogWriter(IOutputStream& output);
+    // Writes all remaining records
+    ~TAsyncLogWriter();
+
+    void Write(const TRecord& record);
+
+private:
+    void Flush();
+
+private:
+    IOutputStream& Output;
+    THolder<TThread> Writer;
+    TManualEvent WriterStopped;
+
+    TMutex Mutex;
+    std::vector<TRecord> Records;
+    // Owned by writer thread, swapped with Records to keep buffers allocated
+    std::vector<TRecord> WrittenRecords;
+};
+
+// Stream over duplicate of stdout descriptor, Cout is written by main thread and can not
+// be shared with writer thread, so async log is written into stdout through this stream
+THolder<IOutputStream> MakeStdoutLogOutput();
+
+}  // namespace NKqpRun
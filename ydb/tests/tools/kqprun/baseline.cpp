@@ -0,0 +1,152 @@
+#include "baseline.h"
+
+#include <library/cpp/colorizer/colors.h>
+
+#include <util/generic/yexception.h>
+#include <util/string/printf.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+
+namespace NKqpRun {
+
+namespace {
+
+std::vector<double> GetSamples(const NJson::TJsonValue& query) {
+    std::vector<double> samples;
+    const NJson::TJsonValue* samplesJson = nullptr;
+    if (!query.GetValuePointer("samples_us", &samplesJson)) {
+        return samples;
+    }
+    samples.reserve(samplesJson->GetArray().size());
+    for (const auto& sample : samplesJson->GetArray()) {
+        samples.emplace_back(sample.GetDoubleRobust());
+    }
+    return samples;
+}
+
+double GetMedian(std::vector<double> samples) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const size_t middle = samples.size() / 2;
+    std::nth_element(samples.begin(), samples.begin() + middle, samples.end());
+    return samples[middle];
+}
+
+std::map<TString, const NJson::TJsonValue*> GetQueries(const NJson::TJsonValue& report) {
+    std::map<TString, const NJson::TJsonValue*> queries;
+    const NJson::TJsonValue* queriesJson = nullptr;
+    if (!report.GetValuePointer("queries", &queriesJson) || !queriesJson->IsArray()) {
+        ythrow yexception() << "Latency report has no queries, expected report of kqprun -p queries";
+    }
+    for (const auto& query : queriesJson->GetArray()) {
+        queries.emplace(query["name"].GetStringRobust(), &query);
+    }
+    return queries;
+}
+
+}  // anonymous namespace
+
+double MannWhitneyPValue(const std::vector<double>& first, const std::vector<double>& second) {
+    const double n1 = first.size();
+    const double n2 = second.size();
+    if (first.empty() || second.empty()) {
+        return 1.0;
+    }
+
+    std::vector<std::pair<double, bool>> values;
+    values.reserve(first.size() + second.size());
+    for (const double value : first) {
+        values.emplace_back(value, true);
+    }
+    for (const double value : second) {
+        values.emplace_back(value, false);
+    }
+    std::sort(values.begin(), values.end());
+
+    // Tied values get average rank
+    double firstRanks = 0.0;
+    double tiesCorrection = 0.0;
+    for (size_t i = 0; i < values.size();) {
+        size_t j = i;
+        while (j < values.size() && values[j].first == values[i].first) {
+            ++j;
+        }
+        const double rank = (i + j + 1) / 2.0;
+        for (size_t k = i; k < j; ++k) {
+            if (values[k].second) {
+                firstRanks += rank;
+            }
+        }
+        const double ties = j - i;
+        tiesCorrection += ties * ties * ties - ties;
+        i = j;
+    }
+
+    const double n = n1 + n2;
+    const double u = firstRanks - n1 * (n1 + 1) / 2;
+    const double mean = n1 * n2 / 2;
+    const double variance = n1 * n2 / 12 * ((n + 1) - tiesCorrection / (n * (n - 1)));
+    if (variance <= 0.0) {
+        return 1.0;
+    }
+
+    const double z = std::max(std::abs(u - mean) - 0.5, 0.0) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+bool CompareWithBaseline(const NJson::TJsonValue& baseline, const NJson::TJsonValue& current, const TRegressionSettings& settings, IOutputStream& output) {
+    NColorizer::TColors colors = NColorizer::AutoColors(output);
+
+    const auto baselineQueries = GetQueries(baseline);
+    bool regression = false;
+
+    output << colors.Cyan() << "Comparison with baseline, threshold " << Sprintf("%.1f", settings.Threshold * 100) << "%, significance " << settings.Significance << ":" << colors.Default() << Endl;
+    for (const auto& [name, query] : GetQueries(current)) {
+        const auto it = baselineQueries.find(name);
+        if (it == baselineQueries.end()) {
+            output << "  " << name << ": not found in baseline" << Endl;
+            continue;
+        }
+        const auto& baselineQuery = *it->second;
+
+        const auto baselineSamples = GetSamples(baselineQuery);
+        const auto currentSamples = GetSamples(*query);
+        const double baselineMedian = GetMedian(baselineSamples);
+        const double currentMedian = GetMedian(currentSamples);
+        const double change = baselineMedian ? currentMedian / baselineMedian - 1.0 : 0.0;
+        const double pValue = MannWhitneyPValue(baselineSamples, currentSamples);
+        const bool queryRegression = change > settings.Threshold && pValue < settings.Significance;
+        regression |= queryRegression;
+
+        output << "  " << (queryRegression ? colors.Red() : colors.Default()) << name
+            << ": median " << Sprintf("%.3f", baselineMedian / 1000.0) << " -> " << Sprintf("%.3f", currentMedian / 1000.0) << " ms"
+            << " (" << Sprintf("%+.1f", change * 100) << "%)"
+            << ", p-value " << Sprintf("%.4f", pValue)
+            << ", qps " << Sprintf("%.2f", baselineQuery["qps"].GetDoubleRobust()) << " -> " << Sprintf("%.2f", (*query)["qps"].GetDoubleRobust());
+        if (baselineQuery.Has("plan_hash") && query->Has("plan_hash") && baselineQuery["plan_hash"] != (*query)["plan_hash"]) {
+            output << ", plan changed";
+        }
+        if (queryRegression) {
+            output << ", regression";
+        }
+        output << colors.Default() << Endl;
+    }
+
+    // Single measurement per run, so CPU time is reported without statistical test
+    if (baseline.Has("process_cpu_us") && current.Has("process_cpu_us")) {
+        const double baselineCpu = baseline["process_cpu_us"].GetDoubleRobust();
+        const double currentCpu = current["process_cpu_us"].GetDoubleRobust();
+        output << "  process cpu: " << Sprintf("%.3f", baselineCpu / 1e6) << " -> " << Sprintf("%.3f", currentCpu / 1e6) << " s";
+        if (baselineCpu) {
+            output << " (" << Sprintf("%+.1f", (currentCpu / baselineCpu - 1.0) * 100) << "%)";
+        }
+        output << Endl;
+    }
+    return regression;
+}
+
+}  // namespace NKqpRun
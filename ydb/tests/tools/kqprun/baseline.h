@@ -0,0 +1,26 @@
+#pragma once
+
+#include <library/cpp/json/json_value.h>
+
+#include <util/stream/output.h>
+
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Two-sided p-value of Mann-Whitney U test, normal approximation with ties correction
+double MannWhitneyPValue(const std::vector<double>& first, const std::vector<double>& second);
+
+struct TRegressionSettings {
+    // Maximal allowed relative growth of query median latency
+    double Threshold = 0.1;
+    // Latency change is taken into account only if p-value is less than significance
+    double Significance = 0.01;
+};
+
+// Compares latency report (with samples) against baseline report from previous run,
+// queries are matched by name. Returns true if some query latency regressed
+bool CompareWithBaseline(const NJson::TJsonValue& baseline, const NJson::TJsonValue& current, const TRegressionSettings& settings, IOutputStream& output);
+
+}  // namespace NKqpRun
@@ -0,0 +1,87 @@
+#include "baseline.h"
+
+#include <library/cpp/testing/unittest/registar.h>
+
+#include <util/stream/str.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+NJson::TJsonValue MakeReport(const TString& name, const std::vector<ui64>& samples) {
+    NJson::TJsonValue report;
+    auto& query = report["queries"].AppendValue(NJson::TJsonValue(NJson::JSON_MAP));
+    query["name"] = name;
+    auto& samplesJson = query["samples_us"];
+    samplesJson.SetType(NJson::JSON_ARRAY);
+    for (const ui64 sample : samples) {
+        samplesJson.AppendValue(sample);
+    }
+    return report;
+}
+
+std::vector<ui64> MakeSamples(ui64 first, ui64 count) {
+    std::vector<ui64> samples;
+    for (ui64 i = 0; i < count; ++i) {
+        samples.emplace_back(first + i);
+    }
+    return samples;
+}
+
+}  // anonymous namespace
+
+Y_UNIT_TEST_SUITE(MannWhitney) {
+    // Reference values are normal approximation with ties and continuity corrections,
+    // the same as R wilcox.test(first, second, exact = FALSE)
+    Y_UNIT_TEST(DisjointSamples) {
+        UNIT_ASSERT_DOUBLES_EQUAL(MannWhitneyPValue({1, 2, 3, 4, 5}, {6, 7, 8, 9, 10}), 0.012185780355344818, 1e-12);
+        UNIT_ASSERT_DOUBLES_EQUAL(MannWhitneyPValue({6, 7, 8, 9, 10}, {1, 2, 3, 4, 5}), 0.012185780355344818, 1e-12);
+    }
+
+    Y_UNIT_TEST(Ties) {
+        UNIT_ASSERT_DOUBLES_EQUAL(MannWhitneyPValue({1, 2, 2, 3}, {2, 3, 3, 4}), 0.17203370892182296, 1e-12);
+    }
+
+    Y_UNIT_TEST(DifferentSizes) {
+        UNIT_ASSERT_DOUBLES_EQUAL(MannWhitneyPValue({19, 22, 16, 29, 24}, {20, 11, 17, 12}), 0.11134688653314048, 1e-12);
+    }
+
+    Y_UNIT_TEST(Degenerate) {
+        UNIT_ASSERT_VALUES_EQUAL(MannWhitneyPValue({}, {1, 2, 3}), 1.0);
+        UNIT_ASSERT_VALUES_EQUAL(MannWhitneyPValue({1, 2, 3}, {}), 1.0);
+        // All values are tied, so variance is zero
+        UNIT_ASSERT_VALUES_EQUAL(MannWhitneyPValue({5, 5}, {5, 5, 5}), 1.0);
+    }
+}
+
+Y_UNIT_TEST_SUITE(BaselineComparison) {
+    Y_UNIT_TEST(Regression) {
+        const auto baseline = MakeReport("select", MakeSamples(1000, 50));
+        const auto current = MakeReport("select", MakeSamples(2000, 50));
+
+        TStringStream output;
+        UNIT_ASSERT(CompareWithBaseline(baseline, current, {}, output));
+        UNIT_ASSERT_STRING_CONTAINS(output.Str(), "regression");
+    }
+
+    Y_UNIT_TEST(NoRegression) {
+        const auto baseline = MakeReport("select", MakeSamples(1000, 50));
+
+        TStringStream output;
+        UNIT_ASSERT(!CompareWithBaseline(baseline, baseline, {}, output));
+        // Improvement is not regression
+        UNIT_ASSERT(!CompareWithBaseline(MakeReport("select", MakeSamples(2000, 50)), baseline, {}, output));
+        // Small growth is below threshold even if it is significant
+        UNIT_ASSERT(!CompareWithBaseline(baseline, MakeReport("select", MakeSamples(1050, 50)), {}, output));
+    }
+
+    Y_UNIT_TEST(MissingQuery) {
+        TStringStream output;
+        UNIT_ASSERT(!CompareWithBaseline(MakeReport("select", MakeSamples(1000, 10)), MakeReport("insert", MakeSamples(2000, 10)), {}, output));
+        UNIT_ASSERT_STRING_CONTAINS(output.Str(), "insert: not found in baseline");
+        UNIT_ASSERT_EXCEPTION_CONTAINS(CompareWithBaseline(NJson::TJsonValue(), MakeReport("select", {}), {}, output), yexception, "Latency report has no queries");
+    }
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,246 @@
+#include <ydb/tests/tools/kqprun/src/kqp_runner.h>
+
+#include <benchmark/benchmark.h>
+
+#include <util/generic/yexception.h>
+#include <util/stream/output.h>
+#include <util/string/builder.h>
+#include <util/string/cast.h>
+#include <util/string/split.h>
+#include <util/system/env.h>
+
+#include <ydb/library/aclib/aclib.h>
+#include <yql/essentials/minikql/invoke_builtins/mkql_builtins.h>
+#include <yql/essentials/public/udf/udf_static_registry.h>
+
+#include <cstdio>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+
+// Reference workloads of kqprun execution paths on in-process cluster with fixed data set, e.g.:
+//   KQPRUN_BENCHMARK_CPUS=0-7 ./kqprun_benchmark --benchmark_format=json --benchmark_out=results.json
+// Cluster is started once for all benchmarks, all its threads are pinned to KQPRUN_BENCHMARK_CPUS (comma separated
+// list of cpus or ranges), data is generated from fixed seed, so results are comparable across commits on the same host
+
+namespace {
+
+constexpr ui64 NUMBER_ORDERS = 100'000;
+constexpr ui64 NUMBER_CUSTOMERS = 1'000;
+constexpr ui64 NUMBER_REGIONS = 16;
+constexpr ui64 DATA_SEED = 42;
+constexpr ui64 ASYNC_INFLIGHT_LIMIT = 16;
+
+// Runner prints summary of async queries inside FinalizeRunner, there is no silent verbose level,
+// so stdout is redirected to /dev/null while burst is measured and terminal does not affect timings
+class TStdoutSuppressor {
+public:
+    TStdoutSuppressor() {
+        Flush();
+        SavedFd = dup(STDOUT_FILENO);
+        const int nullFd = open("/dev/null", O_WRONLY);
+        Y_ABORT_UNLESS(SavedFd >= 0 && nullFd >= 0, "Failed to redirect stdout");
+        dup2(nullFd, STDOUT_FILENO);
+        close(nullFd);
+    }
+
+    ~TStdoutSuppressor() {
+        Flush();
+        dup2(SavedFd, STDOUT_FILENO);
+        close(SavedFd);
+    }
+
+private:
+    static void Flush() {
+        std::cout.flush();
+        Cout.Flush();
+        fflush(stdout);
+    }
+
+private:
+    int SavedFd = -1;
+};
+
+void PinCpus(const TString& cpus) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const auto& range : StringSplitter(cpus).Split(',').SkipEmpty()) {
+        TStringBuf first, last;
+        if (!range.Token().TrySplit('-', first, last)) {
+            first = last = range.Token();
+        }
+        for (ui32 cpu = FromString<ui32>(first); cpu <= FromString<ui32>(last); ++cpu) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    // Threads of cluster are created later and inherit affinity of main thread
+    if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0) {
+        ythrow TSystemError() << "Failed to pin benchmark to cpus " << cpus;
+    }
+}
+
+NKqpRun::TRequestOptions GetRequestOptions(const TString& query) {
+    return {
+        .Query = query,
+        .Action = NKikimrKqp::EQueryAction::QUERY_ACTION_EXECUTE,
+        .TraceId = "kqprun-benchmark",
+        .PoolId = "",
+        .UserSID = BUILTIN_ACL_ROOT,
+        .Database = "",
+        .Timeout = TDuration::Zero()
+    };
+}
+
+// Values are deterministic multiplicative hashes of row id
+TString GetDataQuery() {
+    return TStringBuilder() << R"(
+        UPSERT INTO `/Root/customers`
+        SELECT * FROM AS_TABLE(ListMap(ListFromRange(0ul, )" << NUMBER_CUSTOMERS << R"(ul), ($id) -> (<|
+            id: $id,
+            region: ($id * 2654435761ul + )" << DATA_SEED << R"(ul) % )" << NUMBER_REGIONS << R"(ul,
+            name: "customer_" || CAST($id AS String)
+        |>)));
+
+        UPSERT INTO `/Root/orders`
+        SELECT * FROM AS_TABLE(ListMap(ListFromRange(0ul, )" << NUMBER_ORDERS << R"(ul), ($id) -> (<|
+            id: $id,
+            customer_id: ($id * 2654435761ul + )" << DATA_SEED << R"(ul) % )" << NUMBER_CUSTOMERS << R"(ul,
+            amount: ($id * 40503ul + )" << DATA_SEED << R"(ul) % 10000ul,
+            comment: "order_" || CAST($id AS String)
+        |>)));
+    )";
+}
+
+class TBenchmarkCluster {
+public:
+    static NKqpRun::TKqpRunner& GetRunner() {
+        static TBenchmarkCluster cluster;
+        return *cluster.Runner;
+    }
+
+private:
+    TBenchmarkCluster() {
+        if (const TString cpus = GetEnv("KQPRUN_BENCHMARK_CPUS")) {
+            PinCpus(cpus);
+        }
+
+        FunctionRegistry = NKikimr::NMiniKQL::CreateFunctionRegistry(NKikimr::NMiniKQL::CreateBuiltinRegistry());
+        NKikimr::NMiniKQL::FillStaticModules(*FunctionRegistry);
+
+        NKqpRun::TRunnerOptions runnerOptions;
+        runnerOptions.YdbSettings.FunctionRegistry = FunctionRegistry.Get();
+        runnerOptions.YdbSettings.AsyncQueriesSettings.InFlightLimit = ASYNC_INFLIGHT_LIMIT;
+        // Least verbose level, its summary is not written to terminal while BM_AsyncBurst is measured
+        runnerOptions.YdbSettings.AsyncQueriesSettings.Verbose = NKqpRun::TAsyncQueriesSettings::EVerbose::Final;
+        Runner = MakeHolder<NKqpRun::TKqpRunner>(runnerOptions);
+
+        const TString schemeQuery = R"(
+            CREATE TABLE `/Root/customers` (
+                id Uint64 NOT NULL,
+                region Uint64,
+                name String,
+                PRIMARY KEY (id)
+            );
+            CREATE TABLE `/Root/orders` (
+                id Uint64 NOT NULL,
+                customer_id Uint64,
+                amount Uint64,
+                comment String,
+                PRIMARY KEY (id)
+            );
+        )";
+        if (!Runner->ExecuteSchemeQuery(GetRequestOptions(schemeQuery))) {
+            ythrow yexception() << "Failed to create benchmark tables";
+        }
+        if (!Runner->ExecuteQuery(GetRequestOptions(GetDataQuery()))) {
+            ythrow yexception() << "Failed to fill benchmark tables";
+        }
+    }
+
+private:
+    TIntrusivePtr<NKikimr::NMiniKQL::IMutableFunctionRegistry> FunctionRegistry;
+    THolder<NKqpRun::TKqpRunner> Runner;
+};
+
+void RunQueryBenchmark(benchmark::State& state, const TString& query) {
+    auto& runner = TBenchmarkCluster::GetRunner();
+    const auto request = GetRequestOptions(query);
+
+    // Query compilation is not measured
+    if (!runner.ExecuteQuery(request)) {
+        state.SkipWithError("Query execution failed");
+        return;
+    }
+    for (auto _ : state) {
+        if (!runner.ExecuteQuery(request)) {
+            state.SkipWithError("Query execution failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // anonymous namespace
+
+static void BM_PointLookup(benchmark::State& state) {
+    RunQueryBenchmark(state, "SELECT * FROM `/Root/orders` WHERE id = 31337ul;");
+}
+BENCHMARK(BM_PointLookup)->Unit(benchmark::kMicrosecond);
+
+static void BM_RangeScan(benchmark::State& state) {
+    RunQueryBenchmark(state, "SELECT COUNT(*), SUM(amount) FROM `/Root/orders` WHERE id BETWEEN 10000ul AND 20000ul;");
+}
+BENCHMARK(BM_RangeScan)->Unit(benchmark::kMillisecond);
+
+static void BM_Aggregation(benchmark::State& state) {
+    RunQueryBenchmark(state, "SELECT customer_id, COUNT(*) AS orders, SUM(amount) AS amount FROM `/Root/orders` GROUP BY customer_id;");
+}
+BENCHMARK(BM_Aggregation)->Unit(benchmark::kMillisecond);
+
+static void BM_Join(benchmark::State& state) {
+    RunQueryBenchmark(state, R"(
+        SELECT c.region AS region, SUM(o.amount) AS amount
+        FROM `/Root/orders` AS o
+        JOIN `/Root/customers` AS c ON o.customer_id = c.id
+        GROUP BY c.region;
+    )");
+}
+BENCHMARK(BM_Join)->Unit(benchmark::kMillisecond);
+
+static void BM_ScriptLargeResult(benchmark::State& state) {
+    auto& runner = TBenchmarkCluster::GetRunner();
+    const auto request = GetRequestOptions("SELECT * FROM `/Root/orders`;");
+
+    for (auto _ : state) {
+        if (!runner.ExecuteScript(request) || !runner.FetchScriptResults()) {
+            state.SkipWithError("Script execution failed");
+            break;
+        }
+        if (!runner.ForgetExecutionOperation()) {
+            state.SkipWithError("Forget script execution failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NUMBER_ORDERS);
+}
+BENCHMARK(BM_ScriptLargeResult)->Unit(benchmark::kMillisecond);
+
+// Completion of async queries is visible only after FinalizeRunner, so whole burst is measured
+static void BM_AsyncBurst(benchmark::State& state) {
+    auto& runner = TBenchmarkCluster::GetRunner();
+    const auto request = GetRequestOptions("SELECT * FROM `/Root/orders` WHERE id = 31337ul;");
+    const i64 burstSize = state.range(0);
+
+    TStdoutSuppressor stdoutSuppressor;
+    for (auto _ : state) {
+        for (i64 i = 0; i < burstSize; ++i) {
+            runner.ExecuteQueryAsync(request);
+        }
+        runner.FinalizeRunner();
+    }
+    state.SetItemsProcessed(state.iterations() * burstSize);
+}
+BENCHMARK(BM_AsyncBurst)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,182 @@
+#include "cardinality_report.h"
+
+#include <library/cpp/colorizer/colors.h>
+
+#include <util/generic/yexception.h>
+#include <util/string/builder.h>
+#include <util/string/cast.h>
+#include <util/string/printf.h>
+
+#include <algorithm>
+
+
+namespace NKqpRun {
+
+namespace {
+
+// Plan properties are written as strings or numbers, estimations may be absent ("No estimate")
+std::optional<double> GetNumber(const NJson::TJsonValue& node, const TString& key) {
+    const NJson::TJsonValue* value = nullptr;
+    if (!node.GetValuePointer(key, &value)) {
+        return std::nullopt;
+    }
+    if (value->IsString()) {
+        double result = 0.0;
+        if (!TryFromString(value->GetString(), result)) {
+            return std::nullopt;
+        }
+        return result;
+    }
+    return value->GetDoubleRobust();
+}
+
+ui64 GetStageOutputRows(const NJson::TJsonValue& stage) {
+    const NJson::TJsonValue* outputRows = stage.GetValueByPath("Stats.OutputRows");
+    if (!outputRows) {
+        return 0;
+    }
+    if (outputRows->IsMap()) {
+        return (*outputRows)["Sum"].GetUIntegerRobust();
+    }
+    return outputRows->GetUIntegerRobust();
+}
+
+}  // anonymous namespace
+
+//// TCardinalityReport::TOperatorStats
+
+double TCardinalityReport::TOperatorStats::GetMeanRows() const {
+    return Executions ? ActualRows / Executions : 0.0;
+}
+
+double TCardinalityReport::TOperatorStats::GetMeanCpuMs() const {
+    return Executions ? CpuMs / Executions : 0.0;
+}
+
+std::optional<double> TCardinalityReport::TOperatorStats::GetMisestimation() const {
+    if (!EstimatedRows || !Executions) {
+        return std::nullopt;
+    }
+    // Empty outputs are compared as one row to avoid infinite ratios
+    const double estimated = std::max(*EstimatedRows, 1.0);
+    const double actual = std::max(GetMeanRows(), 1.0);
+    return std::max(estimated, actual) / std::min(estimated, actual);
+}
+
+//// TCardinalityReport
+
+TCardinalityReport::TCardinalityReport(double misestimationFactor)
+    : MisestimationFactor(misestimationFactor)
+{
+    if (MisestimationFactor < 1.0) {
+        ythrow yexception() << "Cardinality misestimation factor should be at least 1, got " << MisestimationFactor;
+    }
+}
+
+void TCardinalityReport::StartRun(const std::vector<TString>& queryNames) {
+    QueryNames = queryNames;
+    Operators.clear();
+}
+
+void TCardinalityReport::AddQuery(size_t index, const NJson::TJsonValue& plan) {
+    Y_ABORT_UNLESS(index < QueryNames.size());
+    const NJson::TJsonValue* root = nullptr;
+    CollectOperators(index, plan.GetValuePointer("Plan", &root) ? *root : plan);
+}
+
+void TCardinalityReport::CollectOperators(size_t index, const NJson::TJsonValue& node) {
+    if (!node.IsMap()) {
+        return;
+    }
+
+    const NJson::TJsonValue* operators = nullptr;
+    if (node.GetValuePointer("Operators", &operators) && operators->IsArray()) {
+        const ui64 planNodeId = node["PlanNodeId"].GetUIntegerRobust();
+        const auto& operatorsArray = operators->GetArray();
+        for (size_t i = 0; i < operatorsArray.size(); ++i) {
+            const auto& op = operatorsArray[i];
+            auto& stats = Operators[{index, planNodeId, i}];
+            stats.Stage = TStringBuilder() << node["Node Type"].GetStringRobust() << " #" << planNodeId;
+            stats.Name = op["Name"].GetStringRobust();
+            stats.EstimatedRows = GetNumber(op, "E-Rows");
+
+            // Older plans have no operator statistics, then stage output is used for its top operator
+            if (const auto actualRows = GetNumber(op, "A-Rows")) {
+                stats.ActualRows += *actualRows;
+            } else if (i == 0) {
+                stats.ActualRows += GetStageOutputRows(node);
+            } else {
+                continue;
+            }
+            stats.CpuMs += GetNumber(op, "A-SelfCpu").value_or(0.0);
+            stats.Executions++;
+        }
+    }
+
+    const NJson::TJsonValue* plans = nullptr;
+    if (node.GetValuePointer("Plans", &plans) && plans->IsArray()) {
+        for (const auto& child : plans->GetArray()) {
+            CollectOperators(index, child);
+        }
+    }
+}
+
+bool TCardinalityReport::IsMisestimated(const TOperatorStats& stats) const {
+    const auto misestimation = stats.GetMisestimation();
+    return misestimation && *misestimation > MisestimationFactor;
+}
+
+NJson::TJsonValue TCardinalityReport::ToJson() const {
+    NJson::TJsonValue result(NJson::JSON_MAP);
+    result["misestimation_factor"] = MisestimationFactor;
+
+    auto& operators = result["operators"];
+    operators.SetType(NJson::JSON_ARRAY);
+    for (const auto& [id, stats] : Operators) {
+        auto& operatorJson = operators.AppendValue(NJson::TJsonValue(NJson::JSON_MAP));
+        operatorJson["query"] = QueryNames[std::get<0>(id)];
+        operatorJson["stage"] = stats.Stage;
+        operatorJson["operator"] = stats.Name;
+        if (stats.EstimatedRows) {
+            operatorJson["estimated_rows"] = *stats.EstimatedRows;
+        }
+        if (const auto misestimation = stats.GetMisestimation()) {
+            operatorJson["misestimation"] = *misestimation;
+        }
+        operatorJson["actual_rows"] = stats.GetMeanRows();
+        operatorJson["self_cpu_ms"] = stats.GetMeanCpuMs();
+        operatorJson["executions"] = stats.Executions;
+        operatorJson["misestimated"] = IsMisestimated(stats);
+    }
+    return result;
+}
+
+void TCardinalityReport::PrintSummary(IOutputStream& output) const {
+    NColorizer::TColors colors = NColorizer::AutoColors(output);
+
+    output << colors.Cyan() << "Cardinality report, misestimation factor " << MisestimationFactor << ":" << colors.Default() << Endl;
+    if (Operators.empty()) {
+        output << "  no operators, query plans are not available" << Endl;
+        return;
+    }
+
+    std::optional<size_t> currentQuery;
+    for (const auto& [id, stats] : Operators) {
+        if (currentQuery != std::get<0>(id)) {
+            currentQuery = std::get<0>(id);
+            output << "  " << QueryNames[*currentQuery] << ":" << Endl;
+        }
+
+        const bool misestimated = IsMisestimated(stats);
+        output << "    " << (misestimated ? colors.Red() : colors.Default()) << stats.Stage << " " << stats.Name
+            << ": estimated " << (stats.EstimatedRows ? Sprintf("%.0f", *stats.EstimatedRows) : TString("-"))
+            << ", actual " << Sprintf("%.0f", stats.GetMeanRows())
+            << ", self cpu " << Sprintf("%.3f", stats.GetMeanCpuMs()) << " ms";
+        if (misestimated) {
+            output << ", misestimated " << Sprintf("%.1f", *stats.GetMisestimation()) << "x";
+        }
+        output << colors.Default() << Endl;
+    }
+}
+
+}  // namespace NKqpRun
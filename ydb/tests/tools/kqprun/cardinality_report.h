@@ -0,0 +1,55 @@
+#pragma once
+
+#include <library/cpp/json/json_value.h>
+
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+
+#include <map>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Compares optimizer estimations (E-Rows) with actual operator rows (A-Rows) from executed
+// query plans, actual values are averaged over loop iterations
+class TCardinalityReport {
+public:
+    // Operators with estimated and actual rows differing more than factor times are reported as misestimated
+    explicit TCardinalityReport(double misestimationFactor);
+
+    void StartRun(const std::vector<TString>& queryNames);
+    void AddQuery(size_t index, const NJson::TJsonValue& plan);
+
+    NJson::TJsonValue ToJson() const;
+    void PrintSummary(IOutputStream& output) const;
+
+private:
+    struct TOperatorStats {
+        TString Stage;
+        TString Name;
+        std::optional<double> EstimatedRows;
+        double ActualRows = 0.0;
+        double CpuMs = 0.0;
+        ui64 Executions = 0;
+
+        double GetMeanRows() const;
+        double GetMeanCpuMs() const;
+        std::optional<double> GetMisestimation() const;
+    };
+
+    // Query index, stage plan node id and operator position in stage
+    using TOperatorId = std::tuple<size_t, ui64, size_t>;
+
+    void CollectOperators(size_t index, const NJson::TJsonValue& node);
+    bool IsMisestimated(const TOperatorStats& stats) const;
+
+private:
+    const double MisestimationFactor;
+    std::vector<TString> QueryNames;
+    std::map<TOperatorId, TOperatorStats> Operators;
+};
+
+}  // namespace NKqpRun
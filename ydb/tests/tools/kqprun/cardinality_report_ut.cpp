@@ -0,0 +1,104 @@
+#include "cardinality_report.h"
+
+#include <library/cpp/json/json_reader.h>
+#include <library/cpp/testing/unittest/registar.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+// Scan operator has no A-Rows, so stage output rows are used for it
+const TString PLAN = R"({
+    "Plan": {
+        "Node Type": "Query",
+        "Plans": [{
+            "Node Type": "ResultSet",
+            "PlanNodeId": 3,
+            "Operators": [
+                {"Name": "Limit", "E-Rows": "10", "A-Rows": 10, "A-SelfCpu": 0.5},
+                {"Name": "Filter", "E-Rows": "No estimate"}
+            ],
+            "Plans": [{
+                "Node Type": "TableFullScan",
+                "PlanNodeId": 1,
+                "Operators": [{"Name": "TableFullScan", "E-Rows": 1000}],
+                "Stats": {"OutputRows": {"Sum": 100}}
+            }]
+        }]
+    }
+})";
+
+NJson::TJsonValue ParsePlan(const TString& text) {
+    NJson::TJsonValue plan;
+    UNIT_ASSERT(NJson::ReadJsonTree(text, &plan));
+    return plan;
+}
+
+}  // anonymous namespace
+
+Y_UNIT_TEST_SUITE(CardinalityReport) {
+    Y_UNIT_TEST(Misestimation) {
+        TCardinalityReport report(2.0);
+        report.StartRun({"select"});
+        report.AddQuery(0, ParsePlan(PLAN));
+        report.AddQuery(0, ParsePlan(PLAN));
+
+        const auto json = report.ToJson();
+        UNIT_ASSERT_DOUBLES_EQUAL(json["misestimation_factor"].GetDouble(), 2.0, 1e-9);
+
+        // Operators are ordered by query, plan node and operator position
+        const auto& operators = json["operators"].GetArray();
+        UNIT_ASSERT_VALUES_EQUAL(operators.size(), 3);
+
+        const auto& scan = operators[0];
+        UNIT_ASSERT_VALUES_EQUAL(scan["query"].GetString(), "select");
+        UNIT_ASSERT_VALUES_EQUAL(scan["stage"].GetString(), "TableFullScan #1");
+        UNIT_ASSERT_VALUES_EQUAL(scan["operator"].GetString(), "TableFullScan");
+        UNIT_ASSERT_DOUBLES_EQUAL(scan["estimated_rows"].GetDouble(), 1000.0, 1e-9);
+        UNIT_ASSERT_DOUBLES_EQUAL(scan["actual_rows"].GetDouble(), 100.0, 1e-9);
+        UNIT_ASSERT_DOUBLES_EQUAL(scan["misestimation"].GetDouble(), 10.0, 1e-9);
+        UNIT_ASSERT_VALUES_EQUAL(scan["executions"].GetUInteger(), 2);
+        UNIT_ASSERT(scan["misestimated"].GetBoolean());
+
+        const auto& limit = operators[1];
+        UNIT_ASSERT_VALUES_EQUAL(limit["operator"].GetString(), "Limit");
+        UNIT_ASSERT_DOUBLES_EQUAL(limit["actual_rows"].GetDouble(), 10.0, 1e-9);
+        UNIT_ASSERT_DOUBLES_EQUAL(limit["self_cpu_ms"].GetDouble(), 0.5, 1e-9);
+        UNIT_ASSERT_DOUBLES_EQUAL(limit["misestimation"].GetDouble(), 1.0, 1e-9);
+        UNIT_ASSERT(!limit["misestimated"].GetBoolean());
+
+        // Filter has neither estimation nor actual rows
+        const auto& filter = operators[2];
+        UNIT_ASSERT_VALUES_EQUAL(filter["operator"].GetString(), "Filter");
+        UNIT_ASSERT_VALUES_EQUAL(filter["executions"].GetUInteger(), 0);
+        UNIT_ASSERT(!filter.Has("estimated_rows"));
+        UNIT_ASSERT(!filter.Has("misestimation"));
+        UNIT_ASSERT(!filter["misestimated"].GetBoolean());
+    }
+
+    Y_UNIT_TEST(EmptyOutput) {
+        // Empty outputs are compared as one row
+        TCardinalityReport report(5.0);
+        report.StartRun({"select"});
+        report.AddQuery(0, ParsePlan(R"({"Plan": {"Node Type": "Stage", "PlanNodeId": 1, "Operators": [{"Name": "Filter", "E-Rows": "4", "A-Rows": 0}]}})"));
+
+        const auto& filter = report.ToJson()["operators"][0];
+        UNIT_ASSERT_DOUBLES_EQUAL(filter["misestimation"].GetDouble(), 4.0, 1e-9);
+        UNIT_ASSERT(!filter["misestimated"].GetBoolean());
+    }
+
+    Y_UNIT_TEST(StartRunResets) {
+        TCardinalityReport report(2.0);
+        report.StartRun({"select"});
+        report.AddQuery(0, ParsePlan(PLAN));
+        report.StartRun({"select"});
+        UNIT_ASSERT(report.ToJson()["operators"].GetArray().empty());
+    }
+
+    Y_UNIT_TEST(InvalidFactor) {
+        UNIT_ASSERT_EXCEPTION_CONTAINS(TCardinalityReport(0.5), yexception, "should be at least 1");
+    }
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,81 @@
+#include "data_generator.h"
+
+#include <util/generic/algorithm.h>
+#include <util/generic/yexception.h>
+#include <util/string/ascii.h>
+#include <util/string/builder.h>
+#include <util/string/escape.h>
+
+#include <algorithm>
+
+
+namespace NKqpRun {
+
+namespace {
+
+// Names are quoted with backticks and types are inserted into query as is
+void ValidateTable(const TScenario::TTable& table) {
+    if (!table.Path || table.Path.Contains('`')) {
+        ythrow yexception() << "Invalid data table path '" << table.Path << "'";
+    }
+    for (const auto& column : table.Columns) {
+        if (!column.Name || column.Name.Contains('`')) {
+            ythrow yexception() << "Invalid column name '" << column.Name << "' in data table " << table.Path;
+        }
+        const bool validType = column.Type && AllOf(column.Type, [](char c) {
+            return IsAsciiAlnum(c) || c == '_' || c == '<' || c == '>' || c == '(' || c == ')' || c == ',' || c == ' ' || c == '?';
+        });
+        if (!validType) {
+            ythrow yexception() << "Invalid type '" << column.Type << "' of column " << column.Name << " in data table " << table.Path;
+        }
+    }
+}
+
+}  // anonymous namespace
+
+TUpsertBatchGenerator::TUpsertBatchGenerator(const TScenario::TTable& table, ui64 seed)
+    : Table(table)
+    , Rng(seed)
+{
+    ValidateTable(Table);
+
+    TStringBuilder header;
+    header << "UPSERT INTO `" << Table.Path << "` (";
+    for (size_t i = 0; i < Table.Columns.size(); ++i) {
+        const auto& column = Table.Columns[i];
+        header << (i ? ", " : "") << "`" << column.Name << "`";
+        Generators.emplace_back(CreateParamGenerator(column.Generator));
+    }
+    header << ") VALUES\n";
+    Header = header;
+}
+
+bool TUpsertBatchGenerator::Next(TString& query) {
+    if (GeneratedRows >= Table.Rows) {
+        return false;
+    }
+
+    const ui64 batchSize = std::min(Table.BatchSize, Table.Rows - GeneratedRows);
+    TStringBuilder builder;
+    builder.reserve(Header.size() + batchSize * Table.Columns.size() * 32);
+    builder << Header;
+    for (ui64 row = 0; row < batchSize; ++row) {
+        builder << (row ? ",\n(" : "(");
+        for (size_t i = 0; i < Table.Columns.size(); ++i) {
+            // Values are casted from string literals, so generators and column types are independent
+            builder << (i ? ", " : "") << "Unwrap(CAST(\"" << EscapeC(Generators[i]->Next(Rng)) << "\" AS " << Table.Columns[i].Type << "))";
+        }
+        builder << ")";
+    }
+    builder << ";";
+
+    GeneratedRows += batchSize;
+    query = std::move(builder);
+    return true;
+}
+
+ui64 TUpsertBatchGenerator::GetGeneratedRows() const {
+    return GeneratedRows;
+}
+
+}  // namespace NKqpRun
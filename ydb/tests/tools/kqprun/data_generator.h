@@ -0,0 +1,31 @@
+#pragma once
+
+#include "query_params.h"
+#include "scenario.h"
+
+#include <util/random/fast.h>
+
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Generates UPSERT queries with batches of rows for scenario data table
+class TUpsertBatchGenerator {
+public:
+    TUpsertBatchGenerator(const TScenario::TTable& table, ui64 seed);
+
+    // Returns false when all rows are generated
+    bool Next(TString& query);
+
+    ui64 GetGeneratedRows() const;
+
+private:
+    const TScenario::TTable& Table;
+    TFastRng64 Rng;
+    std::vector<IParamGenerator::TPtr> Generators;
+    TString Header;
+    ui64 GeneratedRows = 0;
+};
+
+}  // namespace NKqpRun
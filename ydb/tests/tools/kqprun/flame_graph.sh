@@ -2,6 +2,9 @@
 
 # For svg graph download https://github.com/brendangregg/FlameGraph
 # and run `FlameGraph/stackcollapse-perf.pl profdata.txt | FlameGraph/flamegraph.pl > profdata.svg`
+#
+# To profile only measured queries without root use kqprun option --profile-output profdata.folded
+# and run `FlameGraph/flamegraph.pl profdata.folded > profdata.svg`
 
 pid=$(pgrep -u $USER kqprun)
 
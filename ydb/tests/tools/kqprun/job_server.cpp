@@ -0,0 +1,139 @@
+#include "job_server.h"
+
+#include <library/cpp/http/misc/httpcodes.h>
+#include <library/cpp/http/misc/parsed_request.h>
+#include <library/cpp/http/server/http.h>
+#include <library/cpp/http/server/response.h>
+#include <library/cpp/json/json_reader.h>
+#include <library/cpp/json/json_writer.h>
+
+#include <util/string/builder.h>
+#include <util/system/condvar.h>
+#include <util/system/mutex.h>
+
+#include <deque>
+
+
+namespace NKqpRun {
+
+class TJobServer::TImpl : public THttpServer::ICallBack {
+    class TReplier : public TRequestReplier {
+    public:
+        explicit TReplier(TImpl& server)
+            : Server(server)
+        {}
+
+        bool DoReply(const TReplyParams& params) override {
+            const TParsedHttpFull request(params.Input.FirstLine());
+
+            if (request.Path == "/ping") {
+                Reply(params.Output, HTTP_OK, "ok");
+            } else if (request.Path == "/stop" && request.Method == "POST") {
+                Server.Stop();
+                Reply(params.Output, HTTP_OK, "stopping");
+            } else if (request.Path == "/job" && request.Method == "POST") {
+                NJson::TJsonValue job;
+                if (!NJson::ReadJsonTree(params.Input.ReadAll(), &job) || !job.IsMap()) {
+                    Reply(params.Output, HTTP_BAD_REQUEST, "expected json map with job description");
+                    return true;
+                }
+                const NJson::TJsonValue response = Server.AddJob(std::move(job)).GetValueSync();
+                Reply(params.Output, response["status"].GetString() == "success" ? HTTP_OK : HTTP_INTERNAL_SERVER_ERROR, NJson::WriteJson(response, true), "application/json");
+            } else {
+                Reply(params.Output, HTTP_NOT_FOUND, TStringBuilder() << "unknown handler " << request.Method << " " << request.Path);
+            }
+            return true;
+        }
+
+    private:
+        static void Reply(IOutputStream& output, HttpCodes code, const TString& content, TStringBuf contentType = "text/plain") {
+            output << THttpResponse(code).SetContent(content, contentType);
+        }
+
+    private:
+        TImpl& Server;
+    };
+
+public:
+    explicit TImpl(ui16 port)
+        // Jobs run arbitrary queries on embedded cluster, so API is not exposed outside of host
+        : HttpServer(this, THttpServer::TOptions(port).SetHost("localhost").SetThreads(2))
+    {
+        if (!HttpServer.Start()) {
+            ythrow yexception() << "Failed to start job server on localhost:" << port << ", reason: " << HttpServer.GetError();
+        }
+    }
+
+    ~TImpl() {
+        HttpServer.Stop();
+    }
+
+    TClientRequest* CreateClient() override {
+        return new TReplier(*this);
+    }
+
+    NThreading::TFuture<NJson::TJsonValue> AddJob(NJson::TJsonValue request) {
+        auto promise = NThreading::NewPromise<NJson::TJsonValue>();
+
+        TGuard<TMutex> guard(Mutex);
+        if (Stopped) {
+            promise.SetValue(ErrorResponse("kqprun daemon is stopping"));
+        } else {
+            Jobs.push_back({.Request = std::move(request), .Response = promise});
+            JobsCondVar.Signal();
+        }
+        return promise.GetFuture();
+    }
+
+    void Stop() {
+        TGuard<TMutex> guard(Mutex);
+        Stopped = true;
+        JobsCondVar.Signal();
+    }
+
+    std::optional<TJob> WaitJob() {
+        TGuard<TMutex> guard(Mutex);
+        while (Jobs.empty() && !Stopped) {
+            JobsCondVar.WaitI(Mutex);
+        }
+        if (Stopped) {
+            for (auto& job : Jobs) {
+                job.Response.SetValue(ErrorResponse("kqprun daemon is stopping"));
+            }
+            Jobs.clear();
+            return std::nullopt;
+        }
+
+        TJob job = std::move(Jobs.front());
+        Jobs.pop_front();
+        return job;
+    }
+
+private:
+    static NJson::TJsonValue ErrorResponse(const TString& message) {
+        NJson::TJsonValue response;
+        response["status"] = "error";
+        response["error"] = message;
+        return response;
+    }
+
+private:
+    THttpServer HttpServer;
+
+    TMutex Mutex;
+    TCondVar JobsCondVar;
+    std::deque<TJob> Jobs;
+    bool Stopped = false;
+};
+
+TJobServer::TJobServer(ui16 port)
+    : Impl(MakeHolder<TImpl>(port))
+{}
+
+TJobServer::~TJobServer() = default;
+
+std::optional<TJobServer::TJob> TJobServer::WaitJob() {
+    return Impl->WaitJob();
+}
+
+}  // namespace NKqpRun
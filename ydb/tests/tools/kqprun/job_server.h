@@ -0,0 +1,37 @@
+#pragma once
+
+#include <library/cpp/json/json_value.h>
+#include <library/cpp/threading/future/future.h>
+
+#include <util/generic/ptr.h>
+
+#include <optional>
+
+
+namespace NKqpRun {
+
+// HTTP server accepting kqprun jobs while running as daemon, listens only on localhost:
+//   POST /job   -- json with job description, replies with job latency report when job is finished
+//   POST /stop  -- finish daemon after current job
+//   GET  /ping
+// Jobs are not executed by server threads, they are handed out to the caller of WaitJob
+class TJobServer {
+public:
+    struct TJob {
+        NJson::TJsonValue Request;
+        NThreading::TPromise<NJson::TJsonValue> Response;
+    };
+
+public:
+    explicit TJobServer(ui16 port);
+    ~TJobServer();
+
+    // Blocks until next job is submitted, returns nullopt after stop request
+    std::optional<TJob> WaitJob();
+
+private:
+    class TImpl;
+    THolder<TImpl> Impl;
+};
+
+}  // namespace NKqpRun
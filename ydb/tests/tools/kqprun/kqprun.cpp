@@ -1,15 +1,48 @@
+#include "async_log.h"
+#include "baseline.h"
+#include "cardinality_report.h"
+#include "data_generator.h"
+#include "job_server.h"
+#include "latency_stats.h"
+#include "load_schedule.h"
+#include "memory_report.h"
+#include "metrics.h"
+#include "plan_stats.h"
+#include "profiler.h"
+#include "query_trace.h"
+#include "replay.h"
+#include "result_capture.h"
+#include "scenario.h"
+#include "spilling_report.h"
+#include "thread_usage.h"
+
 #include "src/kqp_runner.h"
 
 #include <cstdio>
+#include <functional>
 
 #include <contrib/libs/protobuf/src/google/protobuf/text_format.h>
 
 #include <library/cpp/colorizer/colors.h>
 #include <library/cpp/getopt/last_getopt.h>
 #include <library/cpp/getopt/small/modchooser.h>
+#include <library/cpp/json/json_reader.h>
+#include <library/cpp/json/json_writer.h>
 
+#include <util/folder/dirut.h>
+#include <util/generic/algorithm.h>
+#include <util/generic/hash_set.h>
+#include <util/random/fast.h>
 #include <util/stream/file.h>
+#include <util/stream/str.h>
+#include <util/string/printf.h>
+#include <util/string/split.h>
 #include <util/system/env.h>
+#include <util/system/file.h>
+#include <util/system/filemap.h>
+#include <util/system/fs.h>
+#include <util/system/info.h>
+#include <util/thread/pool.h>
 
 #include <ydb/core/base/backtrace.h>
 
@@ -30,13 +63,49 @@ struct TExecutionOptions {
         AsyncQuery
     };
 
+    struct TPoolLimitsSweep {
+        TString PoolId;
+        std::vector<ui64> ConcurrentQueryLimits;
+    };
+
+    struct TMemoryLimitSweep {
+        ui64 MinLimit = 0;
+        ui64 MaxLimit = 0;
+    };
+
+    struct TExecutorSweep {
+        TString PoolName;
+        std::vector<ui32> Threads;
+        std::vector<ui32> SpinThresholds;
+    };
+
     std::vector<TString> ScriptQueries;
     TString SchemeQuery;
+    std::vector<NKqpRun::TScenario::TTable> DataTables;
+    // Value of ${STORE} template in scheme and script queries
+    TString StoreType;
+    bool StoreComparison = false;
+    // Measure sizes of fetched results to report fetch throughput
+    bool FetchReport = false;
+    // Collect compile cache hits and compile / execute time split from plans
+    bool CompilationReport = false;
+    // Report server side duration of async queries from plans printed on their completion
+    bool AsyncServerDuration = false;
+    // Seed of data generation and randomized timeouts
+    ui64 Seed = 0;
     bool UseTemplates = false;
 
     ui32 LoopCount = 1;
+    ui32 WarmupCount = 0;
     TDuration LoopDelay;
     bool ContinueAfterFail = false;
+    NKqpRun::TRpsSchedule::TSettings RpsSchedule;
+    TPoolLimitsSweep PoolLimitsSweep;
+    std::vector<ui32> ScalingSweepNodeCounts;
+    TMemoryLimitSweep MemoryLimitSweep;
+    // Each -p query gets uniformly distributed timeout from [min, max]
+    std::optional<std::pair<TDuration, TDuration>> RandomTimeouts;
+    TExecutorSweep ExecutorSweep;
 
     bool ForgetExecution = false;
     std::vector<EExecutionCase> ExecutionCases;
@@ -46,22 +115,64 @@ struct TExecutionOptions {
     std::vector<TString> PoolIds;
     std::vector<TString> UserSIDs;
     std::vector<TDuration> Timeouts;
+    std::vector<TString> QueryNames;
+    std::vector<ui64> QueryWeights;
     ui64 ResultsRowsLimit = 0;
+    bool StreamResults = false;
+    // High rate mode, loop steps are logged asynchronously and request options are built once if possible
+    bool QuietLoop = false;
+
+    IOutputStream* LatencyReportOutput = nullptr;
+    NKqpRun::TSamplingProfiler::TSettings ProfilerSettings;
+    std::shared_ptr<NKqpRun::TQueryTrace> QueryTrace;
+    std::shared_ptr<NKqpRun::TCardinalityReport> CardinalityReport;
+    std::shared_ptr<NKqpRun::TMemoryReport> MemoryReport;
+    std::shared_ptr<NKqpRun::TSpillingReport> SpillingReport;
+    // Shared between all runs and jobs, exported by metrics server
+    std::shared_ptr<NKqpRun::TClientMetrics> Metrics;
+    TString BaselineSaveFile;
+    TString BaselineCompareFile;
+    NKqpRun::TRegressionSettings RegressionSettings;
+    // Set when some of reports require script query plans with statistics
+    NKqpRun::TPlanCapture* PlanCapture = nullptr;
+    // Set when fetch report is enabled
+    NKqpRun::TResultCapture* ResultCapture = nullptr;
+
+    // Replay of captured query log instead of -p queries
+    std::vector<NKqpRun::TReplayRecord> ReplayRecords;
+    double ReplaySpeedup = 1.0;
+    EExecutionCase ReplayExecutionCase = EExecutionCase::AsyncQuery;
+
+    ui16 JobsPort = 0;
 
     const TString DefaultTraceId = "kqprun";
+    const TDuration BehindScheduleThreshold = TDuration::MilliSeconds(1);
+    // Memory limit sweep stops when relative search interval is less than precision
+    const double MemoryLimitSweepPrecision = 0.05;
 
     bool HasResults() const {
         for (size_t i = 0; i < ScriptQueries.size(); ++i) {
-            if (GetScriptQueryAction(i) != NKikimrKqp::EQueryAction::QUERY_ACTION_EXECUTE) {
-                continue;
-            }
-            if (GetExecutionCase(i) != EExecutionCase::AsyncQuery) {
+            if (HasResults(i)) {
                 return true;
             }
         }
         return false;
     }
 
+    bool HasResults(size_t index) const {
+        return GetScriptQueryAction(index) == NKikimrKqp::EQueryAction::QUERY_ACTION_EXECUTE && GetExecutionCase(index) != EExecutionCase::AsyncQuery;
+    }
+
+    static const std::map<TString, EExecutionCase>& GetExecutionCaseChoices() {
+        static const std::map<TString, EExecutionCase> choices = {
+            {"script", EExecutionCase::GenericScript},
+            {"query", EExecutionCase::GenericQuery},
+            {"yql-script", EExecutionCase::YqlScript},
+            {"async", EExecutionCase::AsyncQuery}
+        };
+        return choices;
+    }
+
     bool HasExecutionCase(EExecutionCase executionCase) const {
         if (ExecutionCases.empty()) {
             return executionCase == EExecutionCase::GenericScript;
@@ -69,6 +180,21 @@ struct TExecutionOptions {
         return std::find(ExecutionCases.begin(), ExecutionCases.end(), executionCase) != ExecutionCases.end();
     }
 
+    bool HasOnlyExecutionCase(EExecutionCase executionCase) const {
+        if (ExecutionCases.empty()) {
+            return executionCase == EExecutionCase::GenericScript;
+        }
+        return AllOf(ExecutionCases, [executionCase](EExecutionCase value) {
+            return value == executionCase;
+        });
+    }
+
+    // Plans of async queries are printed on completion and can not be told apart from plans of other
+    // queries, so server duration is taken from plans only for scripts of async queries
+    bool TrackAsyncServerDuration() const {
+        return AsyncServerDuration && PlanCapture;
+    }
+
     EExecutionCase GetExecutionCase(size_t index) const {
         return GetValue(index, ExecutionCases, EExecutionCase::GenericScript);
     }
@@ -77,11 +203,55 @@ struct TExecutionOptions {
         return GetValue(index, ScriptQueryActions, NKikimrKqp::EQueryAction::QUERY_ACTION_EXECUTE);
     }
 
+    bool NeedQueryPlans() const {
+        return QueryTrace || CardinalityReport || MemoryReport || SpillingReport || UseBaseline() || StoreComparison || CompilationReport || AsyncServerDuration || !ScalingSweepNodeCounts.empty() || PoolLimitsSweep.PoolId;
+    }
+
+    bool UseBaseline() const {
+        return BaselineSaveFile || BaselineCompareFile;
+    }
+
+    bool HasSweep() const {
+        return PoolLimitsSweep.PoolId || !ScalingSweepNodeCounts.empty() || MemoryLimitSweep.MaxLimit || StoreComparison || ExecutorSweep.PoolName;
+    }
+
+    // Threads are sampled by background thread, so their usage is collected only if it is reported
+    bool NeedThreadUsage() const {
+        return LatencyReportOutput || HasSweep();
+    }
+
+    TString GetQueryName(size_t index) const {
+        return index < QueryNames.size() ? QueryNames[index] : TString(TStringBuilder() << "query " << index);
+    }
+
+    std::vector<TString> GetQueryNames() const {
+        std::vector<TString> names;
+        names.reserve(ScriptQueries.size());
+        for (size_t i = 0; i < ScriptQueries.size(); ++i) {
+            names.emplace_back(GetQueryName(i));
+        }
+        return names;
+    }
+
+    std::vector<NKqpRun::TQueryLatencyStats::TQueryInfo> GetLatencyStatsQueries() const {
+        std::vector<NKqpRun::TQueryLatencyStats::TQueryInfo> queries;
+        queries.reserve(ScriptQueries.size());
+        for (size_t i = 0; i < ScriptQueries.size(); ++i) {
+            queries.push_back({
+                .Name = GetQueryName(i),
+                .SubmitLatency = GetExecutionCase(i) == EExecutionCase::AsyncQuery,
+                .PoolId = GetValue(i, PoolIds, TString())
+            });
+        }
+        return queries;
+    }
+
     NKqpRun::TRequestOptions GetSchemeQueryOptions() const {
         TString sql = SchemeQuery;
         if (UseTemplates) {
             ReplaceYqlTokenTemplate(sql);
         }
+        ReplaceStoreTemplate(sql);
 
         return {
             .Query = sql,
@@ -94,7 +264,39 @@ struct TExecutionOptions {
         };
     }
 
-    NKqpRun::TRequestOptions GetScriptQueryOptions(size_t index, size_t queryId, TInstant startTime) const {
+    NKqpRun::TRequestOptions GetDataLoadOptions(const NKqpRun::TScenario::TTable& table, TString query) const {
+        return {
+            .Query = std::move(query),
+            .Action = NKikimrKqp::EQueryAction::QUERY_ACTION_EXECUTE,
+            .TraceId = TStringBuilder() << DefaultTraceId << "-load",
+            .PoolId = "",
+            .UserSID = BUILTIN_ACL_ROOT,
+            .Database = table.Database.value_or(TString()),
+            .Timeout = TDuration::Zero()
+        };
+    }
+
+    NKqpRun::TRequestOptions GetAlterPoolOptions(const TString& poolId, ui64 concurrentQueryLimit) const {
+        TString database;
+        for (size_t i = 0; i < ScriptQueries.size(); ++i) {
+            if (GetValue(i, PoolIds, TString()) == poolId) {
+                database = GetValue(i, Databases, TString());
+                break;
+            }
+        }
+
+        return {
+            .Query = TStringBuilder() << "ALTER RESOURCE POOL `" << poolId << "` SET (CONCURRENT_QUERY_LIMIT = " << concurrentQueryLimit << ");",
+            .Action = NKikimrKqp::EQueryAction::QUERY_ACTION_EXECUTE,
+            .TraceId = DefaultTraceId,
+            .PoolId = "",
+            .UserSID = BUILTIN_ACL_ROOT,
+            .Database = database,
+            .Timeout = TDuration::Zero()
+        };
+    }
+
+    NKqpRun::TRequestOptions GetScriptQueryOptions(size_t index, size_t queryId, TInstant startTime, std::optional<TDuration> timeout = std::nullopt) const {
         Y_ABORT_UNLESS(index < ScriptQueries.size());
 
         TString sql = ScriptQueries[index];
@@ -102,20 +304,31 @@ struct TExecutionOptions {
             ReplaceYqlTokenTemplate(sql);
             SubstGlobal(sql, "${QUERY_ID}", ToString(queryId));
         }
+        ReplaceStoreTemplate(sql);
 
         return {
             .Query = sql,
             .Action = GetScriptQueryAction(index),
-            .TraceId = TStringBuilder() << GetValue(index, TraceIds, DefaultTraceId) << "-" << startTime.ToString(),
+            .TraceId = TStringBuilder() << GetTraceIdPrefix(index) << startTime.ToString(),
             .PoolId = GetValue(index, PoolIds, TString()),
             .UserSID = GetValue(index, UserSIDs, TString(BUILTIN_ACL_ROOT)),
             .Database = GetValue(index, Databases, TString()),
-            .Timeout = GetValue(index, Timeouts, TDuration::Zero())
+            .Timeout = timeout.value_or(GetValue(index, Timeouts, TDuration::Zero()))
         };
     }
 
+    // Trace id of script query is prefix followed by query start time
+    TString GetTraceIdPrefix(size_t index) const {
+        return TStringBuilder() << GetValue(index, TraceIds, DefaultTraceId) << "-";
+    }
+
+    // Query texts do not depend on query id, so request options can be reused between loop steps
+    bool CanPrepareScriptQueries() const {
+        return !UseTemplates;
+    }
+
     void Validate(const NKqpRun::TRunnerOptions& runnerOptions) const {
-        if (!SchemeQuery && ScriptQueries.empty() && !runnerOptions.YdbSettings.MonitoringEnabled && !runnerOptions.YdbSettings.GrpcEnabled) {
+        if (!SchemeQuery && ScriptQueries.empty() && ReplayRecords.empty() && !IsDaemon(runnerOptions)) {
             ythrow yexception() << "Nothing to execute and is not running as daemon";
         }
 
@@ -123,9 +336,22 @@ struct TExecutionOptions {
         ValidateSchemeQueryOptions(runnerOptions);
         ValidateScriptExecutionOptions(runnerOptions);
         ValidateAsyncOptions(runnerOptions.YdbSettings.AsyncQueriesSettings);
+        ValidateRpsScheduleOptions(runnerOptions.YdbSettings.AsyncQueriesSettings);
+        ValidatePoolLimitsSweepOptions();
+        ValidateScalingSweepOptions(runnerOptions);
+        ValidateBaselineOptions(runnerOptions);
+        ValidateMemoryLimitSweepOptions(runnerOptions);
+        ValidateStoreComparisonOptions(runnerOptions);
+        ValidateExecutorSweepOptions(runnerOptions);
+        ValidateRandomTimeoutsOptions();
+        ValidateReplayOptions();
         ValidateTraceOpt(runnerOptions.TraceOptType);
     }
 
+    bool IsDaemon(const NKqpRun::TRunnerOptions& runnerOptions) const {
+        return runnerOptions.YdbSettings.MonitoringEnabled || runnerOptions.YdbSettings.GrpcEnabled || JobsPort;
+    }
+
 private:
     void ValidateOptionsSizes() const {
         const auto checker = [numberQueries = ScriptQueries.size()](size_t checkSize, const TString& optionName) {
@@ -141,6 +367,10 @@ private:
         checker(PoolIds.size(), "pool ids");
         checker(UserSIDs.size(), "user SIDs");
         checker(Timeouts.size(), "timeouts");
+
+        if (!QueryWeights.empty() && QueryWeights.size() != ScriptQueries.size()) {
+            ythrow yexception() << "Query weights should be specified for all queries";
+        }
     }
 
     void ValidateSchemeQueryOptions(const NKqpRun::TRunnerOptions& runnerOptions) const {
@@ -153,6 +383,42 @@ private:
     }
 
     void ValidateScriptExecutionOptions(const NKqpRun::TRunnerOptions& runnerOptions) const {
+        if (LatencyReportOutput && ScriptQueries.empty()) {
+            ythrow yexception() << "Latency report can not be used without script queries";
+        }
+        if ((ProfilerSettings.CpuProfileOutput || ProfilerSettings.HeapProfileOutput) && ScriptQueries.empty()) {
+            ythrow yexception() << "Profiler can not be used without script queries";
+        }
+        if (QueryTrace && ScriptQueries.empty()) {
+            ythrow yexception() << "Query trace can not be used without script queries";
+        }
+        if (CardinalityReport && ScriptQueries.empty()) {
+            ythrow yexception() << "Cardinality report can not be used without script queries";
+        }
+        if (MemoryReport && ScriptQueries.empty()) {
+            ythrow yexception() << "Memory report can not be used without script queries";
+        }
+        if (SpillingReport && ScriptQueries.empty()) {
+            ythrow yexception() << "Spilling report can not be used without script queries";
+        }
+        if (FetchReport && ScriptQueries.empty()) {
+            ythrow yexception() << "Fetch report can not be used without script queries";
+        }
+        if (FetchReport && !LatencyReportOutput) {
+            ythrow yexception() << "Fetch report can not be used without --latency-report";
+        }
+        if (AsyncServerDuration && !LatencyReportOutput) {
+            ythrow yexception() << "Async server duration can not be used without --latency-report";
+        }
+        if (AsyncServerDuration && !HasOnlyExecutionCase(EExecutionCase::AsyncQuery)) {
+            ythrow yexception() << "Async server duration can be used only if all script queries are async";
+        }
+        if (CompilationReport && ScriptQueries.empty()) {
+            ythrow yexception() << "Compilation report can not be used without script queries";
+        }
+        if (WarmupCount && ScriptQueries.empty()) {
+            ythrow yexception() << "Warmup count can not be used without script queries";
+        }
         if (runnerOptions.YdbSettings.SameSession && HasExecutionCase(EExecutionCase::AsyncQuery)) {
             ythrow yexception() << "Same session can not be used with async quries";
         }
@@ -175,6 +441,9 @@ private:
         if (ResultsRowsLimit) {
             ythrow yexception() << "Result rows limit can not be used without script queries";
         }
+        if (StreamResults) {
+            ythrow yexception() << "Stream results can not be used without script queries";
+        }
         if (runnerOptions.InProgressStatisticsOutputFile) {
             ythrow yexception() << "Script statistics can not be used without script queries";
         }
@@ -205,6 +474,196 @@ private:
         }
     }
 
+    void ValidateRpsScheduleOptions(const NKqpRun::TAsyncQueriesSettings& asyncQueriesSettings) const {
+        if (!RpsSchedule.TargetRps) {
+            if (RpsSchedule.RampUp || !RpsSchedule.Steps.empty()) {
+                ythrow yexception() << "Rps ramp up and steps can not be used without target rps";
+            }
+            return;
+        }
+        // Schedule constructor checks rates and steps, it should fail before cluster is started
+        const NKqpRun::TRpsSchedule schedule(RpsSchedule);
+
+        if (ScriptQueries.empty()) {
+            ythrow yexception() << "Target rps can not be used without script queries";
+        }
+        for (size_t i = 0; i < ScriptQueries.size(); ++i) {
+            if (GetExecutionCase(i) != EExecutionCase::AsyncQuery) {
+                ythrow yexception() << "Target rps can be used only with async queries";
+            }
+        }
+        if (LoopDelay) {
+            ythrow yexception() << "Loop delay can not be used with target rps";
+        }
+        // ExecuteQueryAsync blocks on in flight limit, so any limit turns schedule into closed loop
+        if (asyncQueriesSettings.InFlightLimit) {
+            ythrow yexception() << "Target rps requires unlimited in flight queries, please use --inflight-limit 0";
+        }
+    }
+
+    void ValidatePoolLimitsSweepOptions() const {
+        if (!PoolLimitsSweep.PoolId) {
+            return;
+        }
+        if (std::find(PoolIds.begin(), PoolIds.end(), PoolLimitsSweep.PoolId) == PoolIds.end()) {
+            ythrow yexception() << "Pool " << PoolLimitsSweep.PoolId << " from limits sweep is not used by any query";
+        }
+        if (!LoopCount) {
+            ythrow yexception() << "Pool limits sweep can not be used with infinite loop";
+        }
+    }
+
+    void ValidateScalingSweepOptions(const NKqpRun::TRunnerOptions& runnerOptions) const {
+        if (ScalingSweepNodeCounts.empty()) {
+            return;
+        }
+        if (ScriptQueries.empty()) {
+            ythrow yexception() << "Scaling sweep can not be used without script queries";
+        }
+        if (!LoopCount) {
+            ythrow yexception() << "Scaling sweep can not be used with infinite loop";
+        }
+        if (IsDaemon(runnerOptions)) {
+            ythrow yexception() << "Scaling sweep can not be used in daemon mode";
+        }
+        const auto& ydbSettings = runnerOptions.YdbSettings;
+        const ui32 maxNodeCount = *std::max_element(ScalingSweepNodeCounts.begin(), ScalingSweepNodeCounts.end());
+        if (ydbSettings.DisableDiskMock && maxNodeCount + ydbSettings.SharedTenants.size() + ydbSettings.DedicatedTenants.size() > 1) {
+            ythrow yexception() << "Disable disk mock cannot be used for multi node clusters";
+        }
+    }
+
+    void ValidateBaselineOptions(const NKqpRun::TRunnerOptions& runnerOptions) const {
+        if (!UseBaseline()) {
+            return;
+        }
+        if (ScriptQueries.empty()) {
+            ythrow yexception() << "Baseline can not be used without script queries";
+        }
+        if (!LoopCount) {
+            ythrow yexception() << "Baseline can not be used with infinite loop";
+        }
+        if (IsDaemon(runnerOptions)) {
+            ythrow yexception() << "Baseline can not be used in daemon mode";
+        }
+        if (PoolLimitsSweep.PoolId || !ScalingSweepNodeCounts.empty()) {
+            ythrow yexception() << "Baseline can not be used with sweeps";
+        }
+        if (RegressionSettings.Threshold < 0.0) {
+            ythrow yexception() << "Regression threshold should be non negative";
+        }
+        if (RegressionSettings.Significance <= 0.0 || RegressionSettings.Significance >= 1.0) {
+            ythrow yexception() << "Regression significance should be in (0, 1)";
+        }
+    }
+
+    void ValidateMemoryLimitSweepOptions(const NKqpRun::TRunnerOptions& runnerOptions) const {
+        if (!MemoryLimitSweep.MaxLimit) {
+            return;
+        }
+        if (ScriptQueries.empty()) {
+            ythrow yexception() << "Memory limit sweep can not be used without script queries";
+        }
+        if (!MemoryLimitSweep.MinLimit || MemoryLimitSweep.MinLimit >= MemoryLimitSweep.MaxLimit) {
+            ythrow yexception() << "Memory limit sweep minimal limit should be positive and less than maximal limit";
+        }
+        if (HasExecutionCase(EExecutionCase::AsyncQuery)) {
+            ythrow yexception() << "Memory limit sweep can not be used with async queries, their result is not visible";
+        }
+        if (IsDaemon(runnerOptions)) {
+            ythrow yexception() << "Memory limit sweep can not be used in daemon mode";
+        }
+        if (PoolLimitsSweep.PoolId || !ScalingSweepNodeCounts.empty() || UseBaseline()) {
+            ythrow yexception() << "Memory limit sweep can not be used with other sweeps and baseline";
+        }
+    }
+
+    void ValidateStoreComparisonOptions(const NKqpRun::TRunnerOptions& runnerOptions) const {
+        if (!StoreComparison) {
+            return;
+        }
+        if (!SchemeQuery.Contains("${STORE}")) {
+            ythrow yexception() << "Store comparison requires ${STORE} template in scheme query, e.g. WITH (STORE = ${STORE})";
+        }
+        if (ScriptQueries.empty()) {
+            ythrow yexception() << "Store comparison can not be used without script queries";
+        }
+        if (!LoopCount) {
+            ythrow yexception() << "Store comparison can not be used with infinite loop";
+        }
+        if (IsDaemon(runnerOptions)) {
+            ythrow yexception() << "Store comparison can not be used in daemon mode";
+        }
+        if (PoolLimitsSweep.PoolId || !ScalingSweepNodeCounts.empty() || MemoryLimitSweep.MaxLimit || UseBaseline()) {
+            ythrow yexception() << "Store comparison can not be used with sweeps and baseline";
+        }
+    }
+
+    void ValidateExecutorSweepOptions(const NKqpRun::TRunnerOptions& runnerOptions) const {
+        if (!ExecutorSweep.PoolName) {
+            if (!ExecutorSweep.SpinThresholds.empty()) {
+                ythrow yexception() << "Executor spin threshold sweep can not be used without executor sweep";
+            }
+            return;
+        }
+        if (ScriptQueries.empty()) {
+            ythrow yexception() << "Executor sweep can not be used without script queries";
+        }
+        if (!LoopCount) {
+            ythrow yexception() << "Executor sweep can not be used with infinite loop";
+        }
+        if (IsDaemon(runnerOptions)) {
+            ythrow yexception() << "Executor sweep can not be used in daemon mode";
+        }
+        if (PoolLimitsSweep.PoolId || !ScalingSweepNodeCounts.empty() || MemoryLimitSweep.MaxLimit || UseBaseline() || StoreComparison) {
+            ythrow yexception() << "Executor sweep can not be used with other sweeps and baseline";
+        }
+
+        const auto& executors = runnerOptions.YdbSettings.AppConfig.GetActorSystemConfig().GetExecutor();
+        if (std::none_of(executors.begin(), executors.end(), [&](const auto& executor) { return executor.GetName() == ExecutorSweep.PoolName; })) {
+            ythrow yexception() << "Executor " << ExecutorSweep.PoolName << " not found in actor system config, please specify executors in app config";
+        }
+    }
+
+    void ValidateRandomTimeoutsOptions() const {
+        if (!RandomTimeouts) {
+            return;
+        }
+        if (ScriptQueries.empty()) {
+            ythrow yexception() << "Random timeouts can not be used without script queries";
+        }
+        if (!Timeouts.empty()) {
+            ythrow yexception() << "Random timeouts can not be used together with --timeout";
+        }
+        if (!ContinueAfterFail) {
+            ythrow yexception() << "Random timeouts can not be used without --continue-after-fail";
+        }
+        if (!RandomTimeouts->first || RandomTimeouts->first > RandomTimeouts->second) {
+            ythrow yexception() << "Random timeouts minimal value should be positive and not greater than maximal value";
+        }
+    }
+
+    void ValidateReplayOptions() const {
+        if (ReplayRecords.empty()) {
+            return;
+        }
+        if (JobsPort) {
+            ythrow yexception() << "Replay log can not be used in daemon mode";
+        }
+        if (!ScriptQueries.empty()) {
+            ythrow yexception() << "Replay log can not be used together with script queries";
+        }
+        if (HasSweep()) {
+            ythrow yexception() << "Replay log can not be used together with sweeps";
+        }
+        if (ReplaySpeedup <= 0.0) {
+            ythrow yexception() << "Replay speedup should be positive";
+        }
+        if (ReplayExecutionCase != EExecutionCase::AsyncQuery && ReplayExecutionCase != EExecutionCase::GenericQuery) {
+            ythrow yexception() << "Replay log can be executed only as async or query";
+        }
+    }
+
     void ValidateTraceOpt(NKqpRun::TRunnerOptions::ETraceOptType traceOptType) const {
         switch (traceOptType) {
             case NKqpRun::TRunnerOptions::ETraceOptType::Scheme: {
@@ -230,154 +689,1192 @@ private:
     }
 
 private:
-    template <typename TValue>
-    static TValue GetValue(size_t index, const std::vector<TValue>& values, TValue defaultValue) {
-        if (values.empty()) {
-            return defaultValue;
+    template <typename TValue>
+    static TValue GetValue(size_t index, const std::vector<TValue>& values, TValue defaultValue) {
+        if (values.empty()) {
+            return defaultValue;
+        }
+        return values[std::min(index, values.size() - 1)];
+    }
+
+    void ReplaceStoreTemplate(TString& sql) const {
+        if (StoreType) {
+            SubstGlobal(sql, "${STORE}", StoreType);
+        }
+    }
+
+    static void ReplaceYqlTokenTemplate(TString& sql) {
+        const TString variableName = TStringBuilder() << "${" << NKqpRun::YQL_TOKEN_VARIABLE << "}";
+        if (const TString& yqlToken = GetEnv(NKqpRun::YQL_TOKEN_VARIABLE)) {
+            SubstGlobal(sql, variableName, yqlToken);
+        } else if (sql.Contains(variableName)) {
+            ythrow yexception() << "Failed to replace ${YQL_TOKEN} template, please specify YQL_TOKEN environment variable\n";
+        }
+    }
+};
+
+
+// Returns time spent in fetching results of generic script
+std::optional<TDuration> RunArgumentQuery(size_t index, const NKqpRun::TRequestOptions& request, const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner, const NColorizer::TColors& colors) {
+    std::optional<TDuration> fetchTime;
+    switch (executionOptions.GetExecutionCase(index)) {
+        case TExecutionOptions::EExecutionCase::GenericScript: {
+            if (!runner.ExecuteScript(request)) {
+                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Script execution failed";
+            }
+            const TInstant fetchStartTime = TInstant::Now();
+            if (!executionOptions.QuietLoop) {
+                Cout << colors.Yellow() << fetchStartTime.ToIsoStringLocal() << " Fetching script results..." << colors.Default() << Endl;
+            }
+            if (!runner.FetchScriptResults()) {
+                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Fetch script results failed";
+            }
+            fetchTime = TInstant::Now() - fetchStartTime;
+            if (executionOptions.ForgetExecution) {
+                if (!executionOptions.QuietLoop) {
+                    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Forgetting script execution operation..." << colors.Default() << Endl;
+                }
+                if (!runner.ForgetExecutionOperation()) {
+                    ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Forget script execution operation failed";
+                }
+            }
+            break;
+        }
+
+        case TExecutionOptions::EExecutionCase::GenericQuery: {
+            if (!runner.ExecuteQuery(request)) {
+                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Query execution failed";
+            }
+            break;
+        }
+
+        case TExecutionOptions::EExecutionCase::YqlScript: {
+            if (!runner.ExecuteYqlScript(request)) {
+                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Yql script execution failed";
+            }
+            break;
+        }
+
+        case TExecutionOptions::EExecutionCase::AsyncQuery: {
+            runner.ExecuteQueryAsync(request);
+            break;
+        }
+    }
+    return fetchTime;
+}
+
+
+void PrintScriptResults(NKqpRun::TKqpRunner& runner) {
+    try {
+        runner.PrintScriptResults();
+    } catch (...) {
+        ythrow yexception() << "Failed to print script results, reason:\n" <<  CurrentExceptionMessage();
+    }
+}
+
+
+void WriteLatencyReport(const TExecutionOptions& executionOptions, const NJson::TJsonValue& report) {
+    if (executionOptions.LatencyReportOutput) {
+        NJson::WriteJson(executionOptions.LatencyReportOutput, &report, true);
+        *executionOptions.LatencyReportOutput << Endl;
+    }
+}
+
+
+// Untimed runs of all -p queries, failures are allowed only with --continue-after-fail
+void RunWarmup(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+    const size_t numberWarmups = executionOptions.WarmupCount;
+    if (!numberWarmups) {
+        return;
+    }
+
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+    const size_t numberQueries = executionOptions.ScriptQueries.size();
+    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Warming up script queries, " << numberWarmups << " loops..." << colors.Default() << Endl;
+    for (size_t queryId = 0; queryId < numberQueries * numberWarmups; ++queryId) {
+        try {
+            const size_t index = queryId % numberQueries;
+            RunArgumentQuery(index, executionOptions.GetScriptQueryOptions(index, queryId, TInstant::Now()), executionOptions, runner, colors);
+        } catch (const yexception& exception) {
+            if (executionOptions.ContinueAfterFail) {
+                Cerr << colors.Red() <<  CurrentExceptionMessage() << colors.Default() << Endl;
+            } else {
+                throw exception;
+            }
+        }
+    }
+    runner.FinalizeRunner();
+}
+
+
+// Measured loop of -p queries: statistics collectors are set up on construction,
+// each step sends one query and Finish stops collectors and builds run report
+class TScriptQueriesLoop {
+public:
+    TScriptQueriesLoop(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner)
+        : ExecutionOptions(executionOptions)
+        , Runner(runner)
+        , Colors(NColorizer::AutoColors(Cout))
+        , NumberQueries(executionOptions.ScriptQueries.size())
+        , NumberLoops(executionOptions.LoopCount)
+        , QueryNames(executionOptions.GetQueryNames())
+        , LatencyStats(executionOptions.GetLatencyStatsQueries())
+        , PlanHashes(NumberQueries)
+        , PlanTotals(NumberQueries)
+        , TimeoutsRng(executionOptions.Seed)
+        , TrackAsyncServerDuration(executionOptions.TrackAsyncServerDuration())
+        // Plans can be matched with query only if there is one query in script
+        , CompletedQueryIndex(NumberQueries == 1 ? std::optional<size_t>(0) : std::nullopt)
+    {
+        if (ExecutionOptions.PlanCapture) {
+            ExecutionOptions.PlanCapture->ExtractPlan();
+        }
+
+        if (ExecutionOptions.UseBaseline()) {
+            LatencyStats.EnableSamples();
+        }
+        if (ExecutionOptions.RandomTimeouts) {
+            LatencyStats.EnableTimeouts();
+        }
+        if (ExecutionOptions.RpsSchedule.TargetRps) {
+            RpsSchedule.emplace(ExecutionOptions.RpsSchedule);
+            LatencyStats.EnableSchedule(ExecutionOptions.BehindScheduleThreshold);
+        }
+        if (!ExecutionOptions.QueryWeights.empty()) {
+            QueriesMix.emplace(ExecutionOptions.QueryWeights);
+        }
+
+        if (ExecutionOptions.ProfilerSettings.CpuProfileOutput || ExecutionOptions.ProfilerSettings.HeapProfileOutput) {
+            Profiler.emplace(ExecutionOptions.ProfilerSettings);
+            Profiler->Start();
+        }
+
+        if (ExecutionOptions.QueryTrace) {
+            ExecutionOptions.QueryTrace->StartRun(QueryNames);
+        }
+        if (ExecutionOptions.CardinalityReport) {
+            ExecutionOptions.CardinalityReport->StartRun(QueryNames);
+        }
+        if (ExecutionOptions.MemoryReport) {
+            ExecutionOptions.MemoryReport->StartRun(QueryNames);
+        }
+        if (ExecutionOptions.SpillingReport) {
+            ExecutionOptions.SpillingReport->StartRun(QueryNames);
+        }
+
+        if (ExecutionOptions.QuietLoop) {
+            AsyncLogOutput = NKqpRun::MakeStdoutLogOutput();
+            AsyncLog.emplace(*AsyncLogOutput);
+            if (ExecutionOptions.CanPrepareScriptQueries()) {
+                for (size_t i = 0; i < NumberQueries; ++i) {
+                    auto& request = PreparedRequests.emplace_back(ExecutionOptions.GetScriptQueryOptions(i, 0, TInstant::Now()));
+                    request.TraceId = ExecutionOptions.GetTraceIdPrefix(i);
+                    TraceIdPrefixSizes.emplace_back(request.TraceId.size());
+                }
+            }
+        }
+
+        if (ExecutionOptions.NeedThreadUsage()) {
+            ThreadUsage.emplace();
+            ThreadUsage->StartRun();
+        }
+
+        RunStartTime = TInstant::Now();
+        LatencyStats.StartRun(RunStartTime);
+    }
+
+    bool HasNextStep(size_t queryId) const {
+        return queryId < NumberQueries * NumberLoops || NumberLoops == 0;
+    }
+
+    void RunStep(size_t queryId) {
+        const size_t id = QueriesMix ? QueriesMix->Next() : queryId % NumberQueries;
+        if (queryId % NumberQueries == 0 && queryId > 0) {
+            Sleep(ExecutionOptions.LoopDelay);
+        }
+
+        TInstant scheduledTime;
+        if (RpsSchedule) {
+            scheduledTime = RunStartTime + RpsSchedule->GetSendOffset(queryId);
+            NKqpRun::WaitUntil(scheduledTime);
+        }
+
+        std::optional<TDuration> timeout;
+        if (const auto& randomTimeouts = ExecutionOptions.RandomTimeouts) {
+            const ui64 range = (randomTimeouts->second - randomTimeouts->first).MicroSeconds() + 1;
+            timeout = randomTimeouts->first + TDuration::MicroSeconds(TimeoutsRng.Uniform(range));
+        }
+        // Completion of async queries is not visible from runner, so their submission is measured here
+        // and server duration can be taken from plans printed on completion
+        const bool isAsync = ExecutionOptions.GetExecutionCase(id) == TExecutionOptions::EExecutionCase::AsyncQuery;
+        const bool measureTimeout = timeout && !isAsync;
+        const auto& metrics = ExecutionOptions.Metrics;
+
+        const TInstant startTime = TInstant::Now();
+        if (RpsSchedule) {
+            LatencyStats.RecordSendLag(startTime - scheduledTime);
+        }
+        if (AsyncLog) {
+            AsyncLog->Write({.Time = startTime, .Message = "Executing script", .QueryIndex = id, .Loop = queryId / NumberQueries});
+        } else if (!isAsync) {
+            Cout << Colors.Yellow() << startTime.ToIsoStringLocal() << " Executing script";
+            if (NumberQueries > 1) {
+                Cout << " " << id;
+            }
+            if (NumberLoops != 1) {
+                Cout << ", loop " << queryId / NumberQueries;
+            }
+            Cout << "..." << Colors.Default() << Endl;
+        }
+        if (metrics) {
+            if (isAsync) {
+                metrics->QuerySubmitted(QueryNames[id]);
+            } else {
+                metrics->QueryStarted(QueryNames[id]);
+            }
+        }
+
+        bool printResults = false;
+        try {
+            std::optional<NKqpRun::TRequestOptions> requestHolder;
+            if (PreparedRequests.empty()) {
+                requestHolder = ExecutionOptions.GetScriptQueryOptions(id, queryId, startTime, timeout);
+            } else {
+                // Strings of prepared request are reused, only trace id suffix and timeout are changed
+                auto& request = PreparedRequests[id];
+                request.TraceId.resize(TraceIdPrefixSizes[id]);
+                TStringOutput(request.TraceId) << startTime;
+                if (timeout) {
+                    request.Timeout = *timeout;
+                }
+            }
+            const auto& request = requestHolder ? *requestHolder : PreparedRequests[id];
+
+            const TInstant requestTime = TInstant::Now();
+            const auto fetchTime = RunArgumentQuery(id, request, ExecutionOptions, Runner, Colors);
+            const TInstant finishTime = TInstant::Now();
+            if (measureTimeout) {
+                LatencyStats.RecordTimeout(*timeout, finishTime - startTime, true);
+            }
+            LatencyStats.RecordSuccess(id, finishTime - startTime);
+            if (metrics && !isAsync) {
+                metrics->QueryFinished(QueryNames[id], finishTime - startTime, true);
+            }
+
+            RecordQueryStats(id, queryId, startTime, finishTime, fetchTime, isAsync);
+            LatencyStats.RecordClientOverhead((requestTime - startTime) + (TInstant::Now() - finishTime));
+            printResults = ExecutionOptions.StreamResults && ExecutionOptions.HasResults(id);
+        } catch (const yexception& exception) {
+            LatencyStats.RecordFailure(id);
+            if (metrics && !isAsync) {
+                metrics->QueryFinished(QueryNames[id], TInstant::Now() - startTime, false);
+            }
+            if (measureTimeout) {
+                LatencyStats.RecordTimeout(*timeout, TInstant::Now() - startTime, false);
+            }
+            if (TrackAsyncServerDuration) {
+                RecordAsyncServerDurations();
+            } else if (ExecutionOptions.PlanCapture) {
+                ExecutionOptions.PlanCapture->ExtractPlan();
+            }
+            if (ExecutionOptions.ContinueAfterFail) {
+                Cerr << Colors.Red() <<  CurrentExceptionMessage() << Colors.Default() << Endl;
+            } else {
+                throw exception;
+            }
+        }
+
+        // Query is already accounted as succeeded, printing errors are not query failures
+        if (printResults) {
+            try {
+                PrintScriptResults(Runner);
+            } catch (const yexception& exception) {
+                if (ExecutionOptions.ContinueAfterFail) {
+                    Cerr << Colors.Red() <<  CurrentExceptionMessage() << Colors.Default() << Endl;
+                } else {
+                    throw exception;
+                }
+            }
+        }
+    }
+
+    NJson::TJsonValue Finish() {
+        Runner.FinalizeRunner();
+        if (TrackAsyncServerDuration) {
+            RecordAsyncServerDurations();
+        }
+        LatencyStats.FinishRun(TInstant::Now());
+        if (ThreadUsage) {
+            ThreadUsage->FinishRun();
+        }
+        AsyncLog.reset();
+        if (Profiler) {
+            Profiler->Stop();
+        }
+        if (ExecutionOptions.QueryTrace) {
+            ExecutionOptions.QueryTrace->PrintSummary(Cout);
+        }
+
+        NJson::TJsonValue report = LatencyStats.ToJson();
+        if (ThreadUsage) {
+            // Threads are grouped by names (comm), not by actor system executors
+            report["threads"] = ThreadUsage->ToJson();
+            report["threads_grouping"] = "thread name without numeric suffix";
+        }
+        for (size_t i = 0; i < NumberQueries; ++i) {
+            if (PlanHashes[i]) {
+                report["queries"][i]["plan_hash"] = ToString(*PlanHashes[i]);
+            }
+            if (PlanTotals[i].GetExecutions()) {
+                report["queries"][i]["plan_stats"] = PlanTotals[i].ToJson();
+            }
+        }
+        if (ExecutionOptions.CardinalityReport) {
+            ExecutionOptions.CardinalityReport->PrintSummary(Cout);
+            report["cardinality"] = ExecutionOptions.CardinalityReport->ToJson();
+        }
+        if (ExecutionOptions.MemoryReport) {
+            ExecutionOptions.MemoryReport->FinishRun();
+            ExecutionOptions.MemoryReport->PrintSummary(Cout);
+            report["memory"] = ExecutionOptions.MemoryReport->ToJson();
+        }
+        if (ExecutionOptions.SpillingReport) {
+            ExecutionOptions.SpillingReport->FinishRun();
+            ExecutionOptions.SpillingReport->PrintSummary(Cout);
+            report["spilling"] = ExecutionOptions.SpillingReport->ToJson();
+        }
+        if (ExecutionOptions.LatencyReportOutput) {
+            LatencyStats.PrintSummary(Cout);
+            ThreadUsage->PrintSummary(Cout);
+        }
+        WriteLatencyReport(ExecutionOptions, report);
+
+        if (!ExecutionOptions.StreamResults && ExecutionOptions.HasResults()) {
+            PrintScriptResults(Runner);
+        }
+
+        return report;
+    }
+
+private:
+    void RecordAsyncServerDurations() {
+        for (const auto& plan : ExecutionOptions.PlanCapture->ExtractPlans()) {
+            const auto compilation = NKqpRun::ParseCompilationStats(plan);
+            if (compilation && compilation->TotalDuration) {
+                LatencyStats.RecordAsyncServerDuration(CompletedQueryIndex, compilation->TotalDuration);
+            }
+        }
+    }
+
+    // Statistics of succeeded query taken from its plan and fetched results
+    void RecordQueryStats(size_t id, size_t queryId, TInstant startTime, TInstant finishTime, std::optional<TDuration> fetchTime, bool isAsync) {
+        const auto& metrics = ExecutionOptions.Metrics;
+
+        // Plans of async queries are printed on completion and can not be matched with request
+        NJson::TJsonValue plan;
+        if (TrackAsyncServerDuration) {
+            RecordAsyncServerDurations();
+        } else if (ExecutionOptions.PlanCapture && !isAsync) {
+            plan = ExecutionOptions.PlanCapture->ExtractPlan();
+        }
+        const auto stages = NKqpRun::ParseStageStats(plan);
+        if (plan.IsDefined()) {
+            PlanHashes[id] = NKqpRun::GetPlanHash(plan);
+        }
+        PlanTotals[id].Add(stages);
+        const auto compilation = NKqpRun::ParseCompilationStats(plan);
+        if (compilation) {
+            // Server side duration is preferred, it does not include kqprun and runner overheads
+            const TDuration queryDuration = compilation->TotalDuration ? compilation->TotalDuration : finishTime - startTime;
+            LatencyStats.RecordCompilation(id, compilation->FromCache, compilation->Duration, queryDuration - std::min(queryDuration, compilation->Duration));
+            if (metrics) {
+                metrics->AddCompilation(QueryNames[id], compilation->FromCache);
+            }
+            if (compilation->QueuedTime) {
+                LatencyStats.RecordAdmissionWait(id, *compilation->QueuedTime, false);
+            } else if (const TDuration latency = finishTime - startTime; compilation->TotalDuration) {
+                LatencyStats.RecordAdmissionWait(id, latency - std::min(latency, compilation->TotalDuration), true);
+            }
+        }
+        if (fetchTime) {
+            // Fetched results are printed once more without forwarding, outside of measured fetch time
+            std::optional<ui64> resultRows;
+            std::optional<ui64> resultBytes;
+            if (ExecutionOptions.ResultCapture) {
+                try {
+                    const auto size = ExecutionOptions.ResultCapture->Measure([this]() {
+                        PrintScriptResults(Runner);
+                    });
+                    resultRows = size.Rows;
+                    resultBytes = size.Bytes;
+                } catch (const yexception&) {
+                    Cerr << Colors.Red() << "Failed to measure fetched results size, reason: " << CurrentExceptionMessage() << Colors.Default() << Endl;
+                }
+            }
+            LatencyStats.RecordFetch(id, *fetchTime, resultRows, resultBytes);
+            if (metrics && resultBytes) {
+                metrics->AddResult(QueryNames[id], resultRows, *resultBytes);
+            }
+        }
+        if (ExecutionOptions.QueryTrace) {
+            ExecutionOptions.QueryTrace->AddQuery(id, queryId / NumberQueries, startTime, finishTime - startTime, stages, compilation);
+        }
+        if (ExecutionOptions.MemoryReport) {
+            ExecutionOptions.MemoryReport->AddQuery(id, stages);
+        }
+        if (ExecutionOptions.SpillingReport) {
+            ExecutionOptions.SpillingReport->AddQuery(id, stages);
+        }
+        if (ExecutionOptions.CardinalityReport && plan.IsDefined()) {
+            ExecutionOptions.CardinalityReport->AddQuery(id, plan);
+        }
+    }
+
+private:
+    const TExecutionOptions& ExecutionOptions;
+    NKqpRun::TKqpRunner& Runner;
+    const NColorizer::TColors Colors;
+    const size_t NumberQueries;
+    const size_t NumberLoops;
+    const std::vector<TString> QueryNames;
+
+    NKqpRun::TQueryLatencyStats LatencyStats;
+    std::vector<std::optional<ui64>> PlanHashes;
+    std::vector<NKqpRun::TPlanTotals> PlanTotals;
+    TFastRng64 TimeoutsRng;
+    const bool TrackAsyncServerDuration;
+    const std::optional<size_t> CompletedQueryIndex;
+    std::optional<NKqpRun::TRpsSchedule> RpsSchedule;
+    std::optional<NKqpRun::TWeightedRoundRobin> QueriesMix;
+
+    std::optional<NKqpRun::TSamplingProfiler> Profiler;
+    std::optional<NKqpRun::TThreadUsage> ThreadUsage;
+    THolder<IOutputStream> AsyncLogOutput;
+    std::optional<NKqpRun::TAsyncLogWriter> AsyncLog;
+    std::vector<NKqpRun::TRequestOptions> PreparedRequests;
+    std::vector<size_t> TraceIdPrefixSizes;
+
+    TInstant RunStartTime;
+};
+
+
+NJson::TJsonValue RunScriptQueries(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+    RunWarmup(executionOptions, runner);
+
+    TScriptQueriesLoop loop(executionOptions, runner);
+    for (size_t queryId = 0; loop.HasNextStep(queryId); ++queryId) {
+        loop.RunStep(queryId);
+    }
+    return loop.Finish();
+}
+
+
+// Serial loader of scenario data tables, UPSERT batches are executed one by one with ExecuteQuery.
+// Failures of async queries are not visible from runner, so batches are not sent in parallel
+// and --inflight-limit does not apply, load rate is controlled by batch size
+void LoadData(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+
+    for (size_t i = 0; i < executionOptions.DataTables.size(); ++i) {
+        const auto& table = executionOptions.DataTables[i];
+        Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Loading " << table.Rows << " rows into " << table.Path << " by batches of " << table.BatchSize << " rows..." << colors.Default() << Endl;
+
+        const TInstant startTime = TInstant::Now();
+        NKqpRun::TUpsertBatchGenerator generator(table, executionOptions.Seed + i);
+        ui64 generatedRows = 0;
+        ui64 loadedRows = 0;
+        ui64 loadedBytes = 0;
+        ui64 failedBatches = 0;
+        TString query;
+        while (generator.Next(query)) {
+            const ui64 batchRows = generator.GetGeneratedRows() - generatedRows;
+            const ui64 batchBytes = query.size();
+            generatedRows = generator.GetGeneratedRows();
+            if (!runner.ExecuteQuery(executionOptions.GetDataLoadOptions(table, std::move(query)))) {
+                failedBatches++;
+                continue;
+            }
+            loadedRows += batchRows;
+            loadedBytes += batchBytes;
+        }
+
+        const TDuration duration = TInstant::Now() - startTime;
+        const double seconds = std::max(duration.SecondsFloat(), 1e-6);
+        Cout << colors.Cyan() << "Loaded " << loadedRows << " rows into " << table.Path
+            << " in " << Sprintf("%.3f", seconds) << " s"
+            << ", rows/s " << Sprintf("%.0f", loadedRows / seconds)
+            << ", query MB/s " << Sprintf("%.1f", loadedBytes / 1048576.0 / seconds) << colors.Default() << Endl;
+
+        if (failedBatches) {
+            Cerr << colors.Red() << TInstant::Now().ToIsoStringLocal() << " Failed to load " << generator.GetGeneratedRows() - loadedRows << " rows (" << failedBatches << " batches) into " << table.Path << colors.Default() << Endl;
+            if (!executionOptions.ContinueAfterFail) {
+                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Data loading into " << table.Path << " failed";
+            }
+        }
+    }
+}
+
+// Runs scheme query and fills scenario data tables, should be done once per cluster
+void PrepareCluster(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+    if (executionOptions.SchemeQuery) {
+        NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+        Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Executing scheme query..." << colors.Default() << Endl;
+        if (!runner.ExecuteSchemeQuery(executionOptions.GetSchemeQueryOptions())) {
+            ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Scheme query execution failed";
+        }
+    }
+
+    LoadData(executionOptions, runner);
+}
+
+
+// Phase of sweep, the same workload is run with options changed for phase
+struct TSweepPhase {
+    TString Description;
+    // Written into report of phase together with its statistics
+    NJson::TJsonValue Parameters;
+    std::function<void(TExecutionOptions& executionOptions, NKqpRun::TRunnerOptions& runnerOptions)> MutateOptions;
+};
+
+// Common scaffolding of sweeps: runPhase is called for each phase with execution options without latency report,
+// parameters and statistics of phases are collected into report["phases"], caller writes report for whole sweep
+NJson::TJsonValue RunPhases(const TExecutionOptions& executionOptions, const std::vector<TSweepPhase>& phases, const std::function<NJson::TJsonValue(const TExecutionOptions& phaseOptions, const TSweepPhase& phase)>& runPhase) {
+    TExecutionOptions phaseOptions(executionOptions);
+    phaseOptions.LatencyReportOutput = nullptr;
+
+    NJson::TJsonValue report;
+    auto& phasesReport = report["phases"];
+    phasesReport.SetType(NJson::JSON_ARRAY);
+    for (const auto& phase : phases) {
+        auto& phaseReport = phasesReport.AppendValue(phase.Parameters);
+        phaseReport["statistics"] = runPhase(phaseOptions, phase);
+    }
+    return report;
+}
+
+
+NJson::TJsonValue RunPoolLimitsSweep(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+    const auto& sweep = executionOptions.PoolLimitsSweep;
+
+    std::vector<TSweepPhase> sweepPhases;
+    for (const ui64 limit : sweep.ConcurrentQueryLimits) {
+        auto& phase = sweepPhases.emplace_back();
+        phase.Description = TStringBuilder() << "concurrent query limit " << limit << " for pool " << sweep.PoolId;
+        phase.Parameters["concurrent_query_limit"] = limit;
+    }
+
+    // Pool settings are changed on the same cluster, phase options are not used
+    NJson::TJsonValue report = RunPhases(executionOptions, sweepPhases, [&](const TExecutionOptions& phaseOptions, const TSweepPhase& phase) {
+        Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Setting " << phase.Description << "..." << colors.Default() << Endl;
+        if (!runner.ExecuteSchemeQuery(executionOptions.GetAlterPoolOptions(sweep.PoolId, phase.Parameters["concurrent_query_limit"].GetUInteger()))) {
+            ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Failed to change pool " << sweep.PoolId << " settings";
+        }
+        return RunScriptQueries(phaseOptions, runner);
+    });
+    report["pool"] = sweep.PoolId;
+
+    Cout << colors.Cyan() << "Pool " << sweep.PoolId << " limits sweep (ms):" << colors.Default() << Endl;
+    for (const auto& phase : report["phases"].GetArray()) {
+        const auto& pool = phase["statistics"]["pools"][sweep.PoolId];
+        Cout << "  limit " << phase["concurrent_query_limit"].GetUInteger()
+            << ": count " << pool["count"].GetUInteger()
+            << ", failed or rejected " << pool["failed"].GetUInteger()
+            << ", qps " << Sprintf("%.2f", pool["qps"].GetDouble())
+            << ", p50 " << Sprintf("%.3f", pool["p50_us"].GetUInteger() / 1000.0)
+            << ", p99 " << Sprintf("%.3f", pool["p99_us"].GetUInteger() / 1000.0);
+        if (const auto& wait = pool["admission_wait"]; wait.IsDefined()) {
+            Cout << ", admission wait" << (wait["estimated"].GetUInteger() ? " (estimated)" : "")
+                << " p50 " << Sprintf("%.3f", wait["p50_us"].GetUInteger() / 1000.0)
+                << ", p99 " << Sprintf("%.3f", wait["p99_us"].GetUInteger() / 1000.0);
+        }
+        Cout << Endl;
+    }
+
+    WriteLatencyReport(executionOptions, report);
+    return report;
+}
+
+
+NJson::TJsonValue RunReplay(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+
+    const auto& records = executionOptions.ReplayRecords;
+    const bool isAsync = executionOptions.ReplayExecutionCase == TExecutionOptions::EExecutionCase::AsyncQuery;
+    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Replaying " << records.size() << " queries, speedup " << executionOptions.ReplaySpeedup << "..." << colors.Default() << Endl;
+
+    NKqpRun::TReplayReport replayReport;
+    const TInstant runStartTime = TInstant::Now();
+    replayReport.StartRun(runStartTime);
+
+    const TInstant logStartTime = records.front().Timestamp;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto& record = records[i];
+        const TInstant scheduledTime = runStartTime + (record.Timestamp - logStartTime) / executionOptions.ReplaySpeedup;
+        NKqpRun::WaitUntil(scheduledTime);
+
+        const TInstant startTime = TInstant::Now();
+        replayReport.RecordLag(startTime - scheduledTime);
+
+        NKqpRun::TRequestOptions request = {
+            .Query = record.Query,
+            .Action = NKikimrKqp::EQueryAction::QUERY_ACTION_EXECUTE,
+            .TraceId = record.TraceId ? record.TraceId : TString(TStringBuilder() << executionOptions.DefaultTraceId << "-replay-" << i),
+            .PoolId = record.PoolId,
+            .UserSID = record.UserSID ? record.UserSID : TString(BUILTIN_ACL_ROOT),
+            .Database = record.Database,
+            .Timeout = TDuration::Zero()
+        };
+
+        if (isAsync) {
+            runner.ExecuteQueryAsync(request);
+            replayReport.RecordQuery(record, std::nullopt, true);
+            continue;
+        }
+
+        const bool success = runner.ExecuteQuery(request);
+        replayReport.RecordQuery(record, TInstant::Now() - startTime, success);
+        if (!success) {
+            Cerr << colors.Red() << TInstant::Now().ToIsoStringLocal() << " Replay of query " << record.QueryHash << " failed" << colors.Default() << Endl;
+        }
+    }
+    runner.FinalizeRunner();
+    replayReport.FinishRun(TInstant::Now());
+
+    replayReport.PrintSummary(Cout);
+    NJson::TJsonValue report;
+    report["replay"] = replayReport.ToJson();
+    WriteLatencyReport(executionOptions, report);
+    return report;
+}
+
+// Cluster should be prepared by PrepareCluster before
+NJson::TJsonValue RunArgumentQueries(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+    if (executionOptions.PoolLimitsSweep.PoolId) {
+        return RunPoolLimitsSweep(executionOptions, runner);
+    }
+    if (!executionOptions.ReplayRecords.empty()) {
+        return RunReplay(executionOptions, runner);
+    }
+    return RunScriptQueries(executionOptions, runner);
+}
+
+
+class TJobOptionsParser {
+public:
+    TJobOptionsParser(const NJson::TJsonValue& job, const TExecutionOptions& defaultOptions)
+        : Job(job)
+        , Options(defaultOptions)
+    {}
+
+    // Job description uses the same names as command line options, per query options are lists.
+    // Not specified settings are taken from command line, per query lists are always replaced.
+    // Queries are given by text instead of file paths and latency report is returned in job
+    // response, so jobs do not access files of daemon host
+    TExecutionOptions Parse(const NKqpRun::TRunnerOptions& runnerOptions) {
+        Options.SchemeQuery = {};
+        if (const auto* schemeQuery = Job.GetValueByPath("scheme-query")) {
+            Options.SchemeQuery = schemeQuery->GetStringSafe();
+        }
+
+        // Replay log and data tables are supported only from command line, data is loaded once on daemon start
+        Options.ReplayRecords.clear();
+        Options.DataTables.clear();
+
+        Options.ScriptQueries = GetStrings("script-query");
+        if (!Options.SchemeQuery && Options.ScriptQueries.empty()) {
+            ythrow yexception() << "Job has nothing to execute, please specify scheme-query or script-query";
+        }
+
+        Options.ExecutionCases.clear();
+        for (const auto& executionCase : GetStrings("execution-case")) {
+            const auto& choices = TExecutionOptions::GetExecutionCaseChoices();
+            const auto it = choices.find(executionCase);
+            if (it == choices.end()) {
+                ythrow yexception() << "Unknown execution case: " << executionCase;
+            }
+            Options.ExecutionCases.emplace_back(it->second);
+        }
+
+        Options.ScriptQueryActions.clear();
+        Options.QueryNames.clear();
+        Options.QueryWeights.clear();
+        Options.Databases = GetStrings("database");
+        Options.TraceIds = GetStrings("trace-id");
+        Options.PoolIds = GetStrings("pool");
+        Options.UserSIDs = GetStrings("user");
+        Options.Timeouts.clear();
+        for (const auto& timeout : GetStrings("timeout")) {
+            Options.Timeouts.emplace_back(TDuration::MilliSeconds(FromString<ui64>(timeout)));
+        }
+
+        if (const auto* loopCount = Job.GetValueByPath("loop-count")) {
+            Options.LoopCount = loopCount->GetUIntegerRobust();
+        }
+        if (!Options.LoopCount) {
+            ythrow yexception() << "Infinite loop can not be used in daemon job";
+        }
+        if (const auto* warmupCount = Job.GetValueByPath("warmup-count")) {
+            Options.WarmupCount = warmupCount->GetUIntegerRobust();
+        }
+        if (const auto* loopDelay = Job.GetValueByPath("loop-delay")) {
+            Options.LoopDelay = TDuration::MilliSeconds(loopDelay->GetUIntegerRobust());
+        }
+        if (const auto* continueAfterFail = Job.GetValueByPath("continue-after-fail")) {
+            Options.ContinueAfterFail = continueAfterFail->GetBooleanRobust();
+        }
+        if (const auto* targetRps = Job.GetValueByPath("target-rps")) {
+            Options.RpsSchedule.TargetRps = targetRps->GetDoubleRobust();
+        }
+
+        if (Job.Has("latency-report")) {
+            ythrow yexception() << "Latency report of daemon job is returned in job response, latency-report can not be used";
+        }
+        Options.LatencyReportOutput = nullptr;
+
+        Options.JobsPort = 0;
+        Options.Validate(runnerOptions);
+        return Options;
+    }
+
+private:
+    std::vector<TString> GetStrings(const TString& key) const {
+        std::vector<TString> result;
+        const auto* value = Job.GetValueByPath(key);
+        if (!value) {
+            return result;
+        }
+        if (!value->IsArray()) {
+            result.emplace_back(value->GetStringRobust());
+            return result;
+        }
+        for (const auto& item : value->GetArraySafe()) {
+            result.emplace_back(item.GetStringRobust());
+        }
+        return result;
+    }
+
+private:
+    const NJson::TJsonValue& Job;
+    TExecutionOptions Options;
+};
+
+
+void RunAsDaemon(const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions, NKqpRun::TKqpRunner& runner) {
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+
+    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Initialization finished" << colors.Default() << Endl;
+    if (!executionOptions.JobsPort) {
+        while (true) {
+            Sleep(TDuration::Seconds(1));
         }
-        return values[std::min(index, values.size() - 1)];
     }
 
-    static void ReplaceYqlTokenTemplate(TString& sql) {
-        const TString variableName = TStringBuilder() << "${" << NKqpRun::YQL_TOKEN_VARIABLE << "}";
-        if (const TString& yqlToken = GetEnv(NKqpRun::YQL_TOKEN_VARIABLE)) {
-            SubstGlobal(sql, variableName, yqlToken);
-        } else if (sql.Contains(variableName)) {
-            ythrow yexception() << "Failed to replace ${YQL_TOKEN} template, please specify YQL_TOKEN environment variable\n";
+    NKqpRun::TJobServer jobServer(executionOptions.JobsPort);
+    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Waiting for jobs on port " << executionOptions.JobsPort << colors.Default() << Endl;
+
+    size_t jobId = 0;
+    while (auto job = jobServer.WaitJob()) {
+        Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Running job " << jobId << "..." << colors.Default() << Endl;
+
+        NJson::TJsonValue response;
+        response["job_id"] = jobId++;
+        try {
+            TJobOptionsParser parser(job->Request, executionOptions);
+            const TExecutionOptions jobOptions = parser.Parse(runnerOptions);
+            PrepareCluster(jobOptions, runner);
+            response["latency"] = RunArgumentQueries(jobOptions, runner);
+            response["status"] = "success";
+        } catch (...) {
+            const TString error = CurrentExceptionMessage();
+            Cerr << colors.Red() << error << colors.Default() << Endl;
+            response["status"] = "error";
+            response["error"] = error;
         }
+        job->Response.SetValue(std::move(response));
     }
-};
+}
 
 
-void RunArgumentQuery(size_t index, size_t queryId, TInstant startTime, const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+// Boots new cluster and runs scheme query, data loading and -p queries on it
+NJson::TJsonValue RunOnNewCluster(const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions, const TString& description) {
     NColorizer::TColors colors = NColorizer::AutoColors(Cout);
 
-    switch (executionOptions.GetExecutionCase(index)) {
-        case TExecutionOptions::EExecutionCase::GenericScript: {
-            if (!runner.ExecuteScript(executionOptions.GetScriptQueryOptions(index, queryId, startTime))) {
-                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Script execution failed";
-            }
-            Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Fetching script results..." << colors.Default() << Endl;
-            if (!runner.FetchScriptResults()) {
-                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Fetch script results failed";
-            }
-            if (executionOptions.ForgetExecution) {
-                Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Forgetting script execution operation..." << colors.Default() << Endl;
-                if (!runner.ForgetExecutionOperation()) {
-                    ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Forget script execution operation failed";
-                }
-            }
-            break;
-        }
+    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Initialization of kqp runner with " << description << "..." << colors.Default() << Endl;
+    NKqpRun::TKqpRunner runner(runnerOptions);
+    PrepareCluster(executionOptions, runner);
+    NJson::TJsonValue report = RunArgumentQueries(executionOptions, runner);
+    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Finalization of kqp runner with " << description << "..." << colors.Default() << Endl;
 
-        case TExecutionOptions::EExecutionCase::GenericQuery: {
-            if (!runner.ExecuteQuery(executionOptions.GetScriptQueryOptions(index, queryId, startTime))) {
-                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Query execution failed";
-            }
-            break;
+    return report;
+}
+
+
+// Each phase is run on new cluster with options changed by phase
+NJson::TJsonValue RunPhasesOnNewClusters(const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions, const std::vector<TSweepPhase>& phases) {
+    return RunPhases(executionOptions, phases, [&](const TExecutionOptions& phaseOptions, const TSweepPhase& phase) {
+        TExecutionOptions phaseExecutionOptions(phaseOptions);
+        NKqpRun::TRunnerOptions phaseRunnerOptions(runnerOptions);
+        if (phase.MutateOptions) {
+            phase.MutateOptions(phaseExecutionOptions, phaseRunnerOptions);
         }
+        return RunOnNewCluster(phaseExecutionOptions, phaseRunnerOptions, phase.Description);
+    });
+}
 
-        case TExecutionOptions::EExecutionCase::YqlScript: {
-            if (!runner.ExecuteYqlScript(executionOptions.GetScriptQueryOptions(index, queryId, startTime))) {
-                ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Yql script execution failed";
+
+// Boots new cluster for each node count and runs the same workload on it
+void RunScalingSweep(const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions) {
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+
+    std::vector<TSweepPhase> sweepPhases;
+    for (const ui32 nodeCount : executionOptions.ScalingSweepNodeCounts) {
+        auto& phase = sweepPhases.emplace_back();
+        phase.Description = TStringBuilder() << nodeCount << " nodes";
+        phase.Parameters["node_count"] = nodeCount;
+        phase.MutateOptions = [nodeCount](TExecutionOptions&, NKqpRun::TRunnerOptions& phaseRunnerOptions) {
+            phaseRunnerOptions.YdbSettings.NodeCount = nodeCount;
+        };
+    }
+    const NJson::TJsonValue report = RunPhasesOnNewClusters(executionOptions, runnerOptions, sweepPhases);
+    const auto& phases = report["phases"];
+
+    // All nodes are in one process, so only average CPU usage per node is available
+    Cout << colors.Cyan() << "Scaling sweep (ms):" << colors.Default() << Endl;
+    for (const auto& phase : phases.GetArray()) {
+        const ui64 nodeCount = phase["node_count"].GetUInteger();
+        const auto& statistics = phase["statistics"];
+        const auto& total = statistics["total"];
+        const double cores = statistics["process_cpu_cores"].GetDouble();
+        Cout << "  nodes " << nodeCount
+            << ": count " << total["count"].GetUInteger()
+            << ", failed " << total["failed"].GetUInteger()
+            << ", qps " << Sprintf("%.2f", total["qps"].GetDouble())
+            << ", p50 " << Sprintf("%.3f", total["p50_us"].GetUInteger() / 1000.0)
+            << ", p99 " << Sprintf("%.3f", total["p99_us"].GetUInteger() / 1000.0)
+            << ", cpu cores " << Sprintf("%.2f", cores)
+            << ", per node " << Sprintf("%.2f", cores / nodeCount) << Endl;
+
+        // Tasks distribution is known only if plans contain per node statistics
+        std::map<ui64, std::pair<double, ui64>> nodes;
+        for (const auto& query : statistics["queries"].GetArray()) {
+            for (const auto& node : query["plan_stats"]["nodes"].GetArray()) {
+                auto& [tasks, channelBytes] = nodes[node["node_id"].GetUInteger()];
+                tasks += node["tasks"].GetDouble();
+                channelBytes += node["output_channel_bytes"].GetUInteger();
             }
-            break;
         }
+        if (nodes.empty()) {
+            continue;
+        }
+        double maxTasks = 0.0;
+        double sumTasks = 0.0;
+        ui64 maxChannelBytes = 0;
+        ui64 sumChannelBytes = 0;
+        for (const auto& [_, node] : nodes) {
+            maxTasks = std::max(maxTasks, node.first);
+            sumTasks += node.first;
+            maxChannelBytes = std::max(maxChannelBytes, node.second);
+            sumChannelBytes += node.second;
+        }
+        Cout << "    tasks on " << nodes.size() << " nodes: max " << Sprintf("%.1f", maxTasks)
+            << ", mean " << Sprintf("%.1f", sumTasks / nodes.size())
+            << ", channel bytes max " << maxChannelBytes
+            << ", mean " << sumChannelBytes / nodes.size() << Endl;
+    }
 
-        case TExecutionOptions::EExecutionCase::AsyncQuery: {
-            runner.ExecuteQueryAsync(executionOptions.GetScriptQueryOptions(index, queryId, startTime));
-            break;
+    WriteLatencyReport(executionOptions, report);
+}
+
+
+void ProcessBaseline(const TExecutionOptions& executionOptions, const NJson::TJsonValue& report) {
+    if (const TString& file = executionOptions.BaselineSaveFile) {
+        TFileOutput output(file);
+        NJson::WriteJson(&output, &report, true);
+        output << Endl;
+    }
+
+    if (const TString& file = executionOptions.BaselineCompareFile) {
+        NJson::TJsonValue baseline;
+        if (!NJson::ReadJsonTree(TFileInput(file).ReadAll(), &baseline)) {
+            ythrow yexception() << "Failed to parse baseline " << file;
+        }
+        if (NKqpRun::CompareWithBaseline(baseline, report, executionOptions.RegressionSettings, Cout)) {
+            ythrow yexception() << "Performance regression against baseline " << file;
         }
     }
 }
 
 
-void RunArgumentQueries(const TExecutionOptions& executionOptions, NKqpRun::TKqpRunner& runner) {
+// Runs the same workload with ${STORE} = ROW and ${STORE} = COLUMN on separate clusters
+void RunStoreComparison(const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions) {
     NColorizer::TColors colors = NColorizer::AutoColors(Cout);
 
-    if (executionOptions.SchemeQuery) {
-        Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Executing scheme query..." << colors.Default() << Endl;
-        if (!runner.ExecuteSchemeQuery(executionOptions.GetSchemeQueryOptions())) {
-            ythrow yexception() << TInstant::Now().ToIsoStringLocal() << " Scheme query execution failed";
-        }
+    std::vector<TSweepPhase> sweepPhases;
+    for (const TString store : {"ROW", "COLUMN"}) {
+        auto& phase = sweepPhases.emplace_back();
+        phase.Description = TStringBuilder() << "STORE = " << store;
+        phase.Parameters["store"] = to_lower(store);
+        phase.MutateOptions = [store](TExecutionOptions& phaseOptions, NKqpRun::TRunnerOptions&) {
+            phaseOptions.StoreType = store;
+        };
     }
 
-    const size_t numberQueries = executionOptions.ScriptQueries.size();
-    const size_t numberLoops = executionOptions.LoopCount;
-    for (size_t queryId = 0; queryId < numberQueries * numberLoops || numberLoops == 0; ++queryId) {
-        size_t id = queryId % numberQueries;
-        if (id == 0 && queryId > 0) {
-            Sleep(executionOptions.LoopDelay);
-        }
+    // Statistics are reported by store type instead of phases list
+    NJson::TJsonValue report;
+    const NJson::TJsonValue phasesReport = RunPhasesOnNewClusters(executionOptions, runnerOptions, sweepPhases);
+    for (const auto& phase : phasesReport["phases"].GetArray()) {
+        report[phase["store"].GetString()] = phase["statistics"];
+    }
 
-        const TInstant startTime = TInstant::Now();
-        if (executionOptions.GetExecutionCase(id) != TExecutionOptions::EExecutionCase::AsyncQuery) {
-            Cout << colors.Yellow() << startTime.ToIsoStringLocal() << " Executing script";
-            if (numberQueries > 1) {
-                Cout << " " << id;
-            }
-            if (numberLoops != 1) {
-                Cout << ", loop " << queryId / numberQueries;
-            }
-            Cout << "..." << colors.Default() << Endl;
-        }
+    const auto& row = report["row"];
+    const auto& column = report["column"];
+    const auto formatPair = [](const NJson::TJsonValue& rowValue, const NJson::TJsonValue& columnValue, double scale) {
+        return TStringBuilder() << Sprintf("%.3f", rowValue.GetDoubleRobust() / scale) << " / " << Sprintf("%.3f", columnValue.GetDoubleRobust() / scale);
+    };
 
-        try {
-            RunArgumentQuery(id, queryId, startTime, executionOptions, runner);
-        } catch (const yexception& exception) {
-            if (executionOptions.ContinueAfterFail) {
-                Cerr << colors.Red() <<  CurrentExceptionMessage() << colors.Default() << Endl;
-            } else {
-                throw exception;
+    Cout << colors.Cyan() << "Store comparison, row / column (ms, MB):" << colors.Default() << Endl;
+    for (size_t i = 0; i < executionOptions.ScriptQueries.size(); ++i) {
+        const auto& rowQuery = row["queries"][i];
+        const auto& columnQuery = column["queries"][i];
+        Cout << "  " << rowQuery["name"].GetString()
+            << ": p50 " << formatPair(rowQuery["p50_us"], columnQuery["p50_us"], 1000.0)
+            << ", p99 " << formatPair(rowQuery["p99_us"], columnQuery["p99_us"], 1000.0)
+            << ", cpu " << formatPair(rowQuery["plan_stats"]["cpu_us"], columnQuery["plan_stats"]["cpu_us"], 1000.0)
+            << ", read rows " << formatPair(rowQuery["plan_stats"]["table_read_rows"], columnQuery["plan_stats"]["table_read_rows"], 1.0)
+            << ", read bytes " << formatPair(rowQuery["plan_stats"]["table_read_bytes"], columnQuery["plan_stats"]["table_read_bytes"], 1048576.0) << Endl;
+    }
+    Cout << "  process cpu cores: " << formatPair(row["process_cpu_cores"], column["process_cpu_cores"], 1.0) << Endl;
+
+    WriteLatencyReport(executionOptions, report);
+}
+
+
+// Runs the same workload for each number of threads and spin threshold of actor system executor
+void RunExecutorSweep(const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions) {
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+    const auto& sweep = executionOptions.ExecutorSweep;
+
+    // Empty spin thresholds list means threshold from app config
+    std::vector<std::optional<ui32>> spinThresholds(sweep.SpinThresholds.begin(), sweep.SpinThresholds.end());
+    if (spinThresholds.empty()) {
+        spinThresholds.emplace_back(std::nullopt);
+    }
+
+    std::vector<TSweepPhase> sweepPhases;
+    for (const ui32 threads : sweep.Threads) {
+        for (const auto& spinThreshold : spinThresholds) {
+            auto& phase = sweepPhases.emplace_back();
+            TStringBuilder description;
+            description << sweep.PoolName << " executor with " << threads << " threads";
+            phase.Parameters["threads"] = threads;
+            if (spinThreshold) {
+                phase.Parameters["spin_threshold"] = *spinThreshold;
+                description << ", spin threshold " << *spinThreshold;
             }
+            phase.Description = description;
+            phase.MutateOptions = [&sweep, threads, spinThreshold](TExecutionOptions&, NKqpRun::TRunnerOptions& phaseRunnerOptions) {
+                for (auto& executor : *phaseRunnerOptions.YdbSettings.AppConfig.MutableActorSystemConfig()->MutableExecutor()) {
+                    if (executor.GetName() != sweep.PoolName) {
+                        continue;
+                    }
+                    executor.SetThreads(threads);
+                    if (executor.HasMaxThreads()) {
+                        executor.SetMaxThreads(std::max(executor.GetMaxThreads(), threads));
+                    }
+                    if (spinThreshold) {
+                        executor.SetSpinThreshold(*spinThreshold);
+                    }
+                }
+            };
         }
     }
-    runner.FinalizeRunner();
 
-    if (executionOptions.HasResults()) {
-        try {
-            runner.PrintScriptResults();
-        } catch (...) {
-            ythrow yexception() << "Failed to print script results, reason:\n" <<  CurrentExceptionMessage();
+    NJson::TJsonValue report = RunPhasesOnNewClusters(executionOptions, runnerOptions, sweepPhases);
+    report["executor"] = sweep.PoolName;
+    const auto& phases = report["phases"];
+
+    Cout << colors.Cyan() << "Executor " << sweep.PoolName << " sweep (ms):" << colors.Default() << Endl;
+    for (const auto& phase : phases.GetArray()) {
+        const auto& statistics = phase["statistics"];
+        const auto& total = statistics["total"];
+        Cout << "  threads " << phase["threads"].GetUInteger();
+        if (phase.Has("spin_threshold")) {
+            Cout << ", spin threshold " << phase["spin_threshold"].GetUInteger();
         }
+        Cout << ": qps " << Sprintf("%.2f", total["qps"].GetDouble())
+            << ", p50 " << Sprintf("%.3f", total["p50_us"].GetUInteger() / 1000.0)
+            << ", p99 " << Sprintf("%.3f", total["p99_us"].GetUInteger() / 1000.0)
+            << ", cpu cores " << Sprintf("%.2f", statistics["process_cpu_cores"].GetDouble()) << Endl;
     }
+
+    WriteLatencyReport(executionOptions, report);
 }
 
 
-void RunAsDaemon() {
+// Runs query once on new cluster with given query memory limit, returns false if query failed
+bool ProbeMemoryLimit(size_t index, ui64 memoryLimit, const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions) {
     NColorizer::TColors colors = NColorizer::AutoColors(Cout);
 
-    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Initialization finished" << colors.Default() << Endl;
-    while (true) {
-        Sleep(TDuration::Seconds(1));
+    NKqpRun::TRunnerOptions probeRunnerOptions(runnerOptions);
+    probeRunnerOptions.YdbSettings.AppConfig.MutableTableServiceConfig()->MutableResourceManager()->SetQueryMemoryLimit(memoryLimit);
+
+    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Probing " << executionOptions.GetQueryName(index) << " with query memory limit " << memoryLimit << " bytes..." << colors.Default() << Endl;
+    NKqpRun::TKqpRunner runner(probeRunnerOptions);
+    PrepareCluster(executionOptions, runner);
+
+    bool success = true;
+    try {
+        RunArgumentQuery(index, executionOptions.GetScriptQueryOptions(index, 0, TInstant::Now()), executionOptions, runner, colors);
+    } catch (const yexception&) {
+        Cerr << colors.Red() <<  CurrentExceptionMessage() << colors.Default() << Endl;
+        success = false;
+    }
+    if (executionOptions.PlanCapture) {
+        executionOptions.PlanCapture->ExtractPlan();
+    }
+    return success;
+}
+
+
+// Binary search of minimal query memory limit for each -p query, cluster is rebooted for each probe
+void RunMemoryLimitSweep(const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions) {
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+    const auto& sweep = executionOptions.MemoryLimitSweep;
+
+    NJson::TJsonValue report;
+    auto& queries = report["queries"];
+    queries.SetType(NJson::JSON_ARRAY);
+    for (size_t i = 0; i < executionOptions.ScriptQueries.size(); ++i) {
+        auto& query = queries.AppendValue(NJson::TJsonValue(NJson::JSON_MAP));
+        query["name"] = executionOptions.GetQueryName(i);
+
+        ui64 probes = 1;
+        if (ProbeMemoryLimit(i, sweep.MaxLimit, executionOptions, runnerOptions)) {
+            // Invariant: query fails with low limit and succeeds with high limit
+            ui64 low = sweep.MinLimit;
+            ui64 high = sweep.MaxLimit;
+            ++probes;
+            if (ProbeMemoryLimit(i, low, executionOptions, runnerOptions)) {
+                high = low;
+            }
+            while (high - low > high * executionOptions.MemoryLimitSweepPrecision) {
+                const ui64 middle = low + (high - low) / 2;
+                ++probes;
+                if (ProbeMemoryLimit(i, middle, executionOptions, runnerOptions)) {
+                    high = middle;
+                } else {
+                    low = middle;
+                }
+            }
+            query["min_memory_limit_bytes"] = high;
+        }
+        query["probes"] = probes;
+    }
+
+    Cout << colors.Cyan() << "Minimal query memory limits (MB):" << colors.Default() << Endl;
+    for (const auto& query : queries.GetArray()) {
+        Cout << "  " << query["name"].GetString() << ": ";
+        if (query.Has("min_memory_limit_bytes")) {
+            Cout << Sprintf("%.1f", query["min_memory_limit_bytes"].GetUInteger() / 1048576.0);
+        } else {
+            Cout << colors.Red() << "failed with maximal limit" << colors.Default();
+        }
+        Cout << ", probes " << query["probes"].GetUInteger() << Endl;
     }
+
+    WriteLatencyReport(executionOptions, report);
 }
 
 
 void RunScript(const TExecutionOptions& executionOptions, const NKqpRun::TRunnerOptions& runnerOptions) {
+    if (!executionOptions.ScalingSweepNodeCounts.empty()) {
+        RunScalingSweep(executionOptions, runnerOptions);
+        return;
+    }
+    if (executionOptions.MemoryLimitSweep.MaxLimit) {
+        RunMemoryLimitSweep(executionOptions, runnerOptions);
+        return;
+    }
+    if (executionOptions.StoreComparison) {
+        RunStoreComparison(executionOptions, runnerOptions);
+        return;
+    }
+    if (executionOptions.ExecutorSweep.PoolName) {
+        RunExecutorSweep(executionOptions, runnerOptions);
+        return;
+    }
+
     NColorizer::TColors colors = NColorizer::AutoColors(Cout);
 
     Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Initialization of kqp runner..." << colors.Default() << Endl;
     NKqpRun::TKqpRunner runner(runnerOptions);
 
+    NJson::TJsonValue report;
     try {
-        RunArgumentQueries(executionOptions, runner);
+        PrepareCluster(executionOptions, runner);
+        report = RunArgumentQueries(executionOptions, runner);
     } catch (const yexception& exception) {
-        if (runnerOptions.YdbSettings.MonitoringEnabled) {
+        if (runnerOptions.YdbSettings.MonitoringEnabled || executionOptions.JobsPort) {
             Cerr << colors.Red() <<  CurrentExceptionMessage() << colors.Default() << Endl;
         } else {
             throw exception;
         }
     }
 
-    if (runnerOptions.YdbSettings.MonitoringEnabled || runnerOptions.YdbSettings.GrpcEnabled) {
-        RunAsDaemon();
+    if (executionOptions.UseBaseline()) {
+        // Measured run failed and cluster is kept for monitoring or jobs, there are no statistics to save or compare
+        if (!report.IsDefined()) {
+            Cerr << colors.Red() << "Baseline is not saved or compared, measured run failed" << colors.Default() << Endl;
+        } else {
+            ProcessBaseline(executionOptions, report);
+        }
+    }
+
+    if (executionOptions.IsDaemon(runnerOptions)) {
+        RunAsDaemon(executionOptions, runnerOptions, runner);
     }
 
     Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Finalization of kqp runner..." << colors.Default() << Endl;
 }
 
 
+// Reads table files (and their attributes) into page cache in parallel, so file gateway does not wait for disk
+void PrefetchTables(const THashMap<TString, TString>& tablesMapping) {
+    if (tablesMapping.empty()) {
+        return;
+    }
+
+    NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+    Cout << colors.Yellow() << TInstant::Now().ToIsoStringLocal() << " Prefetching " << tablesMapping.size() << " tables..." << colors.Default() << Endl;
+
+    std::vector<TString> files;
+    for (const auto& [_, file] : tablesMapping) {
+        files.emplace_back(file);
+        if (const TString attributesFile = file + ".attr"; NFs::Exists(attributesFile)) {
+            files.emplace_back(attributesFile);
+        }
+    }
+
+    TThreadPool threadPool;
+    threadPool.Start(std::min(files.size(), NSystemInfo::CachedNumberOfCpus()));
+    for (const auto& file : files) {
+        threadPool.SafeAddFunc([file]() {
+            try {
+                TFileMap fileMap(file);
+                if (const i64 size = fileMap.Length()) {
+                    fileMap.Map(0, size);
+                    fileMap.Precharge();
+                }
+            } catch (...) {
+                Cerr << "Failed to prefetch table file " << file << ", reason: " << CurrentExceptionMessage() << Endl;
+            }
+        });
+    }
+    threadPool.Stop();
+}
+
+
 TIntrusivePtr<NKikimr::NMiniKQL::IMutableFunctionRegistry> CreateFunctionRegistry(const TString& udfsDirectory, TVector<TString> udfsPaths, bool excludeLinkedUdfs) {
     if (!udfsDirectory.empty() || !udfsPaths.empty()) {
         NColorizer::TColors colors = NColorizer::AutoColors(Cout);
@@ -385,7 +1882,24 @@ TIntrusivePtr<NKikimr::NMiniKQL::IMutableFunctionRegistry> CreateFunctionRegistr
     }
 
     NKikimr::NMiniKQL::FindUdfsInDir(udfsDirectory, &udfsPaths);
-    auto functionRegistry = NKikimr::NMiniKQL::CreateFunctionRegistry(&PrintBackTrace, NKikimr::NMiniKQL::CreateBuiltinRegistry(), false, udfsPaths)->Clone();
+
+    // Same library can be passed by -u and found in --udfs-dir
+    THashSet<TString> uniquePaths;
+    EraseIf(udfsPaths, [&uniquePaths](const TString& path) {
+        return !uniquePaths.insert(RealPath(path)).second;
+    });
+
+    // Libraries are loaded one by one under dynamic loader lock, so at least start asynchronous readahead of all files
+    for (const auto& path : udfsPaths) {
+        TFile(path, OpenExisting | RdOnly).PrefetchCache(0, 0, false);
+    }
+
+    // Mutable registry is filled directly, without cloning of registry with loaded udfs
+    auto functionRegistry = NKikimr::NMiniKQL::CreateFunctionRegistry(NKikimr::NMiniKQL::CreateBuiltinRegistry());
+    functionRegistry->SetBackTraceCallback(&PrintBackTrace);
+    for (const auto& path : udfsPaths) {
+        functionRegistry->LoadUdfs(path, {});
+    }
 
     if (excludeLinkedUdfs) {
         for (const auto& wrapper : NYql::NUdf::GetStaticUdfModuleWrapperList()) {
@@ -410,15 +1924,59 @@ class TMain : public TMainClassArgs {
     NKqpRun::TRunnerOptions RunnerOptions;
 
     THashMap<TString, TString> TablesMapping;
+    TString ScenarioFile;
+    ui64 Seed = 0;
     TVector<TString> UdfsPaths;
     TString UdfsDirectory;
     bool ExcludeLinkedUdfs = false;
     bool EmulateYt = false;
+    bool PrefetchYtTables = false;
+    IOutputStream* QueryTraceOutput = nullptr;
+    bool CardinalityReport = false;
+    bool MemoryReport = false;
+    TString SpillingRoot;
+    ui32 SpillingIoThreads = 0;
+    bool SpillingReport = false;
+    double CardinalityMisestimationFactor = 10.0;
+    std::unique_ptr<NKqpRun::TPlanCapture> PlanCapture;
+    std::unique_ptr<NKqpRun::TResultCapture> ResultCapture;
+    ui16 MetricsPort = 0;
+    TString ReplayLogFile;
+    std::unique_ptr<NKqpRun::TMetricsServer> MetricsServer;
 
     static TString LoadFile(const TString& file) {
         return TFileInput(file).ReadAll();
     }
 
+    void SetupSpilling() {
+        NFs::MakeDirectoryRecursive(SpillingRoot);
+
+        auto& tableServiceConfig = *RunnerOptions.YdbSettings.AppConfig.MutableTableServiceConfig();
+        tableServiceConfig.SetEnableQueryServiceSpilling(true);
+
+        auto& localFileConfig = *tableServiceConfig.MutableSpillingServiceConfig()->MutableLocalFileConfig();
+        localFileConfig.SetEnable(true);
+        localFileConfig.SetRoot(SpillingRoot);
+        if (SpillingIoThreads) {
+            localFileConfig.MutableIoThreadPool()->SetWorkersCount(SpillingIoThreads);
+        }
+
+        if (SpillingReport) {
+            ExecutionOptions.SpillingReport = std::make_shared<NKqpRun::TSpillingReport>(SpillingRoot);
+        }
+    }
+
+    // Plans are parsed from runner plan output, so it is switched to json format
+    void SetupPlanCapture() {
+        if (RunnerOptions.ScriptQueryPlanOutput && RunnerOptions.PlanOutputFormat != NYdb::NConsoleClient::EDataFormat::JsonUnicode) {
+            ythrow yexception() << "Query plans statistics can be collected only with json plan format, please specify -P json";
+        }
+        RunnerOptions.PlanOutputFormat = NYdb::NConsoleClient::EDataFormat::JsonUnicode;
+        PlanCapture = std::make_unique<NKqpRun::TPlanCapture>(RunnerOptions.ScriptQueryPlanOutput);
+        RunnerOptions.ScriptQueryPlanOutput = PlanCapture.get();
+        ExecutionOptions.PlanCapture = PlanCapture.get();
+    }
+
     static IOutputStream* GetDefaultOutput(const TString& file) {
         if (file == "-") {
             return &Cout;
@@ -472,10 +2030,18 @@ protected:
             .Handler1([this](const NLastGetopt::TOptsParser* option) {
                 ExecutionOptions.ScriptQueries.emplace_back(LoadFile(option->CurVal()));
             });
+        options.AddLongOption("scenario", "Yaml file with weighted mix of queries and their settings (used instead of -p and per query options), tables from data section are filled serially by UPSERT batches of batch_size rows")
+            .RequiredArgument("file")
+            .StoreResult(&ScenarioFile);
         options.AddLongOption("templates", "Enable templates for -s and -p queries, such as ${YQL_TOKEN} and ${QUERY_ID}")
             .NoArgument()
             .SetFlag(&ExecutionOptions.UseTemplates);
 
+        options.AddLongOption("seed", "Random seed for scenario data and --random-timeout")
+            .RequiredArgument("uint")
+            .DefaultValue(Seed)
+            .StoreResult(&Seed);
+
         options.AddLongOption('t', "table", "File with input table (can be used by YT with -E flag), table@file")
             .RequiredArgument("table@file")
             .Handler1([this](const NLastGetopt::TOptsParser* option) {
@@ -547,6 +2113,9 @@ protected:
             .RequiredArgument("file")
             .DefaultValue("-")
             .StoreMappedResultT<TString>(&RunnerOptions.ResultOutput, &GetDefaultOutput);
+        options.AddLongOption("stream-results", "Write results of every -p query into --result-file right after it is finished, by default only results of the last query are written at the end (memory usage is the same, runner keeps only results of the last query)")
+            .NoArgument()
+            .SetFlag(&ExecutionOptions.StreamResults);
         options.AddLongOption('L', "result-rows-limit", "Rows limit for script execution results")
             .RequiredArgument("uint")
             .DefaultValue(0)
@@ -592,6 +2161,68 @@ protected:
             .Choices(planFormat.GetChoices())
             .StoreMappedResultT<TString>(&RunnerOptions.PlanOutputFormat, planFormat);
 
+        options.AddLongOption("latency-report", "File with latency percentiles and throughput of -p queries in json format, CPU usage of threads is grouped by thread name without numeric suffix (use '-' to write in stdout)")
+            .RequiredArgument("file")
+            .StoreMappedResultT<TString>(&ExecutionOptions.LatencyReportOutput, &GetDefaultOutput);
+
+        options.AddLongOption("fetch-report", "Report fetch throughput of generic scripts in --latency-report, result size is measured as bytes printed in --result-format (rows are counted only for rows format)")
+            .NoArgument()
+            .SetFlag(&ExecutionOptions.FetchReport);
+        options.AddLongOption("async-server-duration", "Report server side duration of async -p queries in --latency-report (server_duration), it is taken from plans printed on query completion and does not include queueing in runner, requires json plan format")
+            .NoArgument()
+            .SetFlag(&ExecutionOptions.AsyncServerDuration);
+
+        options.AddLongOption("compilation-report", "Report compile cache hits / misses and compile / execute time of -p queries in --latency-report, taken from query plans (parse time is included into compile time)")
+            .NoArgument()
+            .SetFlag(&ExecutionOptions.CompilationReport);
+
+        options.AddLongOption("baseline-save", "Save latency samples, throughput, process cpu time and plan hashes of -p queries into baseline file")
+            .RequiredArgument("file")
+            .StoreResult(&ExecutionOptions.BaselineSaveFile);
+        options.AddLongOption("baseline-compare", "Compare -p queries with baseline file (Mann-Whitney U test over latency samples) and fail if some query regressed")
+            .RequiredArgument("file")
+            .StoreResult(&ExecutionOptions.BaselineCompareFile);
+        options.AddLongOption("regression-threshold", "Maximal allowed relative growth of query median latency for --baseline-compare")
+            .RequiredArgument("double")
+            .DefaultValue(ExecutionOptions.RegressionSettings.Threshold)
+            .StoreResult(&ExecutionOptions.RegressionSettings.Threshold);
+        options.AddLongOption("regression-significance", "Maximal p-value of latency change for --baseline-compare")
+            .RequiredArgument("double")
+            .DefaultValue(ExecutionOptions.RegressionSettings.Significance)
+            .StoreResult(&ExecutionOptions.RegressionSettings.Significance);
+
+        options.AddLongOption("profile-output", "File with CPU profile of measured -p queries loop in collapsed stacks format (use '-' to write in stdout)")
+            .RequiredArgument("file")
+            .StoreMappedResultT<TString>(&ExecutionOptions.ProfilerSettings.CpuProfileOutput, &GetDefaultOutput);
+        options.AddLongOption("profile-frequency", "Number of CPU profile samples per second of process CPU time")
+            .RequiredArgument("uint")
+            .DefaultValue(ExecutionOptions.ProfilerSettings.Frequency)
+            .StoreResult(&ExecutionOptions.ProfilerSettings.Frequency);
+        options.AddLongOption("heap-profile-output", "File with sampled allocations of measured -p queries loop in collapsed stacks format, requires tcmalloc (use '-' to write in stdout)")
+            .RequiredArgument("file")
+            .StoreMappedResultT<TString>(&ExecutionOptions.ProfilerSettings.HeapProfileOutput, &GetDefaultOutput);
+
+        options.AddLongOption("query-trace-file", "File with -p query executions and plan stages statistics in chrome trace format, stages statistics are taken from query plans")
+            .RequiredArgument("file")
+            .StoreMappedResultT<TString>(&QueryTraceOutput, [](const TString& file) {
+                if (file == "-") {
+                    ythrow yexception() << "Query trace cannot be printed to stdout, please specify file name";
+                }
+                return GetDefaultOutput(file);
+            });
+
+        options.AddLongOption("cardinality-report", "Compare estimated and actual rows of -p query plan operators, report is also written into --latency-report")
+            .NoArgument()
+            .SetFlag(&CardinalityReport);
+        options.AddLongOption("cardinality-factor", "Minimal ratio of estimated and actual rows to report operator as misestimated")
+            .RequiredArgument("double")
+            .DefaultValue(CardinalityMisestimationFactor)
+            .StoreResult(&CardinalityMisestimationFactor);
+
+        options.AddLongOption("memory-report", "Report peak memory and spilling of -p queries from plan statistics and process allocator statistics, report is also written into --latency-report")
+            .NoArgument()
+            .SetFlag(&MemoryReport);
+
         options.AddLongOption("script-timeline-file", "File with script query timline in svg format")
             .RequiredArgument("file")
             .StoreMappedResultT<TString>(&RunnerOptions.ScriptQueryTimelineFile, [](const TString& file) {
@@ -603,12 +2234,7 @@ protected:
 
         // Pipeline settings
 
-        TChoices<TExecutionOptions::EExecutionCase> executionCase({
-            {"script", TExecutionOptions::EExecutionCase::GenericScript},
-            {"query", TExecutionOptions::EExecutionCase::GenericQuery},
-            {"yql-script", TExecutionOptions::EExecutionCase::YqlScript},
-            {"async", TExecutionOptions::EExecutionCase::AsyncQuery}
-        });
+        TChoices<TExecutionOptions::EExecutionCase> executionCase(TExecutionOptions::GetExecutionCaseChoices());
         options.AddLongOption('C', "execution-case", "Type of query for -p argument")
             .RequiredArgument("query-type")
             .Choices(executionCase.GetChoices())
@@ -616,6 +2242,23 @@ protected:
                 TString choice(option->CurValOrDef());
                 ExecutionOptions.ExecutionCases.emplace_back(executionCase(choice));
             });
+        options.AddLongOption("quiet-loop", "High rate mode for -p queries: loop steps are logged by background thread, request options are built once if templates are not used")
+            .NoArgument()
+            .SetFlag(&ExecutionOptions.QuietLoop);
+
+        options.AddLongOption("replay-log", "Replay captured query log in json lines format with original inter-arrival times instead of -p queries, see replay.h for format. Params are inlined into query text as literals, so compile cache hits differ from original workload")
+            .RequiredArgument("file")
+            .StoreResult(&ReplayLogFile);
+        options.AddLongOption("replay-speedup", "Speedup of inter-arrival times for --replay-log")
+            .RequiredArgument("double")
+            .DefaultValue(1.0)
+            .StoreResult(&ExecutionOptions.ReplaySpeedup);
+        options.AddLongOption("replay-execution-case", "Type of query for --replay-log, replayed latencies are compared with recorded only for query")
+            .RequiredArgument("query-type")
+            .Choices({"async", "query"})
+            .DefaultValue("async")
+            .StoreMappedResultT<TString>(&ExecutionOptions.ReplayExecutionCase, executionCase);
+
         options.AddLongOption("inflight-limit", "In flight limit for async queries (use 0 for unlimited)")
             .RequiredArgument("uint")
             .DefaultValue(0)
@@ -624,6 +2267,26 @@ protected:
             {"each-query", NKqpRun::TAsyncQueriesSettings::EVerbose::EachQuery},
             {"final", NKqpRun::TAsyncQueriesSettings::EVerbose::Final}
         });
+        options.AddLongOption("target-rps", "Send async queries in open-loop mode with given rate (requires --inflight-limit 0), delay of sends from schedule is reported as send lag")
+            .RequiredArgument("double")
+            .StoreResult(&ExecutionOptions.RpsSchedule.TargetRps);
+        options.AddLongOption("rps-ramp-up", "Linearly increase rate from zero during specified time in milliseconds (used with --target-rps)")
+            .RequiredArgument("uint")
+            .StoreMappedResultT<ui64>(&ExecutionOptions.RpsSchedule.RampUp, &TDuration::MilliSeconds<ui64>);
+        options.AddLongOption("rps-step", "Send queries with given rate during given time in milliseconds before switching to --target-rps, rps@ms")
+            .RequiredArgument("rps@ms")
+            .Handler1([this](const NLastGetopt::TOptsParser* option) {
+                TStringBuf rps;
+                TStringBuf duration;
+                if (!TStringBuf(option->CurVal()).TrySplit('@', rps, duration)) {
+                    ythrow yexception() << "Incorrect rps step, expected form rps@ms, e.g. 100@5000";
+                }
+                ExecutionOptions.RpsSchedule.Steps.push_back({
+                    .Rps = FromString<double>(rps),
+                    .Duration = TDuration::MilliSeconds(FromString<ui64>(duration))
+                });
+            });
+
         options.AddLongOption("async-verbose", "Verbose type for async queries")
             .RequiredArgument("type")
             .DefaultValue("each-query")
@@ -660,6 +2323,10 @@ protected:
             .RequiredArgument("uint")
             .DefaultValue(ExecutionOptions.LoopCount)
             .StoreResult(&ExecutionOptions.LoopCount);
+        options.AddLongOption("warmup-count", "Number of untimed runs of all -p queries before measured loop (e.g. to fill compile cache)")
+            .RequiredArgument("uint")
+            .DefaultValue(ExecutionOptions.WarmupCount)
+            .StoreResult(&ExecutionOptions.WarmupCount);
         options.AddLongOption("loop-delay", "Delay in milliseconds between loop steps")
             .RequiredArgument("uint")
             .DefaultValue(0)
@@ -680,6 +2347,25 @@ protected:
             .RequiredArgument("pool-id")
             .EmplaceTo(&ExecutionOptions.PoolIds);
 
+        options.AddLongOption("pool-limits-sweep", "Run -p queries once for each concurrent query limit of given pool, pool@limit,limit,...")
+            .RequiredArgument("pool@limits")
+            .Handler1([this](const NLastGetopt::TOptsParser* option) {
+                TStringBuf poolId;
+                TStringBuf limits;
+                if (!TStringBuf(option->CurVal()).TrySplit('@', poolId, limits) || poolId.empty()) {
+                    ythrow yexception() << "Incorrect pool limits sweep, expected form pool@limits, e.g. olap@1,2,4,8";
+                }
+                auto& sweep = ExecutionOptions.PoolLimitsSweep;
+                sweep.PoolId = poolId;
+                sweep.ConcurrentQueryLimits.clear();
+                for (const auto& limit : StringSplitter(limits).Split(',').SkipEmpty()) {
+                    sweep.ConcurrentQueryLimits.emplace_back(FromString<ui64>(limit.Token()));
+                }
+                if (sweep.ConcurrentQueryLimits.empty()) {
+                    ythrow yexception() << "Pool limits sweep requires at least one concurrent query limit";
+                }
+            });
+
         options.AddLongOption("same-session", "Run all -p requests in one session")
             .NoArgument()
             .SetFlag(&RunnerOptions.YdbSettings.SameSession);
@@ -696,6 +2382,73 @@ protected:
                 return nodeCount;
             });
 
+        options.AddLongOption("memory-limit-sweep", "Find minimal query memory limit (table service resource manager QueryMemoryLimit) for each -p query by binary search in range min:max MB, cluster is restarted for each probe")
+            .RequiredArgument("min:max")
+            .Handler1([this](const NLastGetopt::TOptsParser* option) {
+                TStringBuf minLimit;
+                TStringBuf maxLimit;
+                if (!TStringBuf(option->CurVal()).TrySplit(':', minLimit, maxLimit)) {
+                    ythrow yexception() << "Incorrect memory limit sweep, expected form min:max in MB, e.g. 64:16384";
+                }
+                ExecutionOptions.MemoryLimitSweep = {
+                    .MinLimit = FromString<ui64>(minLimit) << 20,
+                    .MaxLimit = FromString<ui64>(maxLimit) << 20
+                };
+            });
+
+        options.AddLongOption("store-comparison", "Run workload twice on new clusters with ${STORE} template in scheme and -p queries replaced by ROW and COLUMN, report latency, cpu and read statistics side by side")
+            .NoArgument()
+            .SetFlag(&ExecutionOptions.StoreComparison);
+
+        options.AddLongOption("executor-sweep", "Run workload on new cluster for each number of threads of actor system executor from app config, executor@threads,threads,... (thread CPU usage in report is grouped by thread name without numeric suffix, not by executor)")
+            .RequiredArgument("executor@threads")
+            .Handler1([this](const NLastGetopt::TOptsParser* option) {
+                TStringBuf poolName;
+                TStringBuf threads;
+                if (!TStringBuf(option->CurVal()).TrySplit('@', poolName, threads) || poolName.empty()) {
+                    ythrow yexception() << "Incorrect executor sweep, expected form executor@threads, e.g. User@1,2,4,8";
+                }
+                auto& sweep = ExecutionOptions.ExecutorSweep;
+                sweep.PoolName = poolName;
+                sweep.Threads.clear();
+                for (const auto& value : StringSplitter(threads).Split(',').SkipEmpty()) {
+                    sweep.Threads.emplace_back(FromString<ui32>(value.Token()));
+                }
+            });
+        options.AddLongOption("executor-spin-sweep", "Spin thresholds of --executor-sweep executor, each value is combined with each number of threads")
+            .RequiredArgument("uints")
+            .Handler1([this](const NLastGetopt::TOptsParser* option) {
+                auto& spinThresholds = ExecutionOptions.ExecutorSweep.SpinThresholds;
+                spinThresholds.clear();
+                for (const auto& value : StringSplitter(option->CurVal()).Split(',').SkipEmpty()) {
+                    spinThresholds.emplace_back(FromString<ui32>(value.Token()));
+                }
+            });
+
+        options.AddLongOption("random-timeout", "Give each -p query uniformly distributed timeout from min:max ms, failures responded after timeout are reported with their delay past timeout (requires --continue-after-fail)")
+            .RequiredArgument("min:max")
+            .Handler1([this](const NLastGetopt::TOptsParser* option) {
+                TStringBuf minTimeout;
+                TStringBuf maxTimeout;
+                if (!TStringBuf(option->CurVal()).TrySplit(':', minTimeout, maxTimeout)) {
+                    ythrow yexception() << "Incorrect random timeout, expected form min:max in ms, e.g. 10:1000";
+                }
+                ExecutionOptions.RandomTimeouts = std::make_pair(TDuration::MilliSeconds(FromString<ui64>(minTimeout)), TDuration::MilliSeconds(FromString<ui64>(maxTimeout)));
+            });
+
+        options.AddLongOption("scaling-sweep", "Run workload on new cluster for each number of nodes, comma separated list, -N is ignored")
+            .RequiredArgument("uints")
+            .Handler1([this](const NLastGetopt::TOptsParser* option) {
+                auto& nodeCounts = ExecutionOptions.ScalingSweepNodeCounts;
+                nodeCounts.clear();
+                for (const auto& nodeCount : StringSplitter(option->CurVal()).Split(',').SkipEmpty()) {
+                    nodeCounts.emplace_back(FromString<ui32>(nodeCount.Token()));
+                    if (nodeCounts.back() < 1) {
+                        ythrow yexception() << "Number of nodes less than one";
+                    }
+                }
+            });
+
         options.AddLongOption('M', "monitoring", "Embedded UI port (use 0 to start on random free port), if used kqprun will be run as daemon")
             .RequiredArgument("uint")
             .Handler1([this](const NLastGetopt::TOptsParser* option) {
@@ -714,10 +2467,22 @@ protected:
                 }
             });
 
+        options.AddLongOption("jobs-port", "Port on localhost for HTTP jobs API (POST /job with json job description, queries are given by text, latency report is returned in response), if used kqprun will be run as daemon")
+            .RequiredArgument("uint")
+            .StoreResult(&ExecutionOptions.JobsPort);
+
+        options.AddLongOption("metrics-port", "Port for HTTP endpoint with kqprun client metrics in prometheus format (GET /metrics), result size needs --fetch-report, compile cache hits need captured plans (e.g. --compilation-report), counters of embedded cluster are served by -M UI on /counters")
+            .RequiredArgument("uint")
+            .StoreResult(&MetricsPort);
+
         options.AddLongOption('E', "emulate-yt", "Emulate YT tables (use file gateway instead of native gateway)")
             .NoArgument()
             .SetFlag(&EmulateYt);
 
+        options.AddLongOption("prefetch-tables", "Read -t table files into page cache in parallel before start (can be used with -E flag)")
+            .NoArgument()
+            .SetFlag(&PrefetchYtTables);
+
         options.AddLongOption("domain", "Test cluster domain name")
             .RequiredArgument("name")
             .DefaultValue(RunnerOptions.YdbSettings.DomainName)
@@ -750,6 +2515,16 @@ protected:
             .NoArgument()
             .SetFlag(&RunnerOptions.YdbSettings.DisableDiskMock);
 
+        options.AddLongOption("spilling-dir", "Enable compute spilling into given directory")
+            .RequiredArgument("directory")
+            .StoreResult(&SpillingRoot);
+        options.AddLongOption("spilling-io-threads", "Number of spilling I/O threads, by default from app config")
+            .RequiredArgument("uint")
+            .StoreResult(&SpillingIoThreads);
+        options.AddLongOption("spilling-report", "Report spilled bytes, spilling throughput and time blocked on spilling per stage of -p queries and peak size of --spilling-dir, report is also written into --latency-report")
+            .NoArgument()
+            .SetFlag(&SpillingReport);
+
         TChoices<std::function<void()>> backtrace({
             {"heavy", &NKikimr::EnableYDBBacktraceFormat},
             {"light", []() { SetFormatBackTraceFn(FormatBackTrace); }}
@@ -764,8 +2539,73 @@ protected:
             });
     }
 
+    void ApplyScenario(const NKqpRun::TScenario& scenario) {
+        auto& options = ExecutionOptions;
+        if (!options.ScriptQueries.empty() || !options.ExecutionCases.empty() || !options.ScriptQueryActions.empty() || !options.Databases.empty()
+            || !options.TraceIds.empty() || !options.PoolIds.empty() || !options.UserSIDs.empty() || !options.Timeouts.empty()) {
+            ythrow yexception() << "Scenario can not be used together with -p and per query options";
+        }
+
+        const auto& executionCases = TExecutionOptions::GetExecutionCaseChoices();
+        for (const auto& query : scenario.Queries) {
+            auto executionCase = TExecutionOptions::EExecutionCase::GenericScript;
+            if (query.ExecutionCase) {
+                const auto it = executionCases.find(*query.ExecutionCase);
+                if (it == executionCases.end()) {
+                    ythrow yexception() << "Unknown execution case " << *query.ExecutionCase << " for scenario query " << query.Name;
+                }
+                executionCase = it->second;
+            }
+
+            options.ScriptQueries.emplace_back(query.Text);
+            options.QueryNames.emplace_back(query.Name);
+            options.QueryWeights.emplace_back(query.Weight);
+            options.ExecutionCases.emplace_back(executionCase);
+            options.TraceIds.emplace_back(query.Name);
+            options.PoolIds.emplace_back(query.PoolId.value_or(TString()));
+            options.Databases.emplace_back(query.Database.value_or(TString()));
+            options.UserSIDs.emplace_back(query.UserSID.value_or(TString(BUILTIN_ACL_ROOT)));
+            options.Timeouts.emplace_back(query.Timeout.value_or(TDuration::Zero()));
+        }
+
+        options.DataTables = scenario.Data;
+    }
+
     int DoRun(NLastGetopt::TOptsParseResult&&) override {
+        if (ScenarioFile) {
+            ApplyScenario(NKqpRun::TScenario::Load(ScenarioFile));
+        }
+        ExecutionOptions.Seed = Seed;
+        if (ReplayLogFile) {
+            ExecutionOptions.ReplayRecords = NKqpRun::LoadReplayLog(ReplayLogFile);
+        }
+        if (QueryTraceOutput) {
+            ExecutionOptions.QueryTrace = std::make_shared<NKqpRun::TQueryTrace>(QueryTraceOutput);
+        }
+        if (CardinalityReport) {
+            ExecutionOptions.CardinalityReport = std::make_shared<NKqpRun::TCardinalityReport>(CardinalityMisestimationFactor);
+        }
+        if (MemoryReport) {
+            ExecutionOptions.MemoryReport = std::make_shared<NKqpRun::TMemoryReport>();
+        }
+        if (SpillingRoot) {
+            SetupSpilling();
+        } else if (SpillingIoThreads || SpillingReport) {
+            ythrow yexception() << "Spilling settings can not be used without spilling directory, please specify --spilling-dir";
+        }
         ExecutionOptions.Validate(RunnerOptions);
+        if (ExecutionOptions.NeedQueryPlans()) {
+            SetupPlanCapture();
+        }
+        if (ExecutionOptions.FetchReport) {
+            ResultCapture = std::make_unique<NKqpRun::TResultCapture>(RunnerOptions.ResultOutput, RunnerOptions.ResultOutputFormat == NKqpRun::TRunnerOptions::EResultOutputFormat::RowsJson);
+            RunnerOptions.ResultOutput = ResultCapture.get();
+            ExecutionOptions.ResultCapture = ResultCapture.get();
+        }
+        if (MetricsPort) {
+            ExecutionOptions.Metrics = std::make_shared<NKqpRun::TClientMetrics>();
+            MetricsServer = std::make_unique<NKqpRun::TMetricsServer>(MetricsPort, ExecutionOptions.Metrics);
+        }
 
         if (RunnerOptions.YdbSettings.DisableDiskMock && RunnerOptions.YdbSettings.NodeCount + RunnerOptions.YdbSettings.SharedTenants.size() + RunnerOptions.YdbSettings.DedicatedTenants.size() > 1) {
             ythrow yexception() << "Disable disk mock cannot be used for multi node clusters";
@@ -778,6 +2618,9 @@ protected:
         }
 
         if (EmulateYt) {
+            if (PrefetchYtTables) {
+                PrefetchTables(TablesMapping);
+            }
             const auto& fileStorageConfig = RunnerOptions.YdbSettings.AppConfig.GetQueryServiceConfig().GetFileStorage();
             auto fileStorage = WithAsync(CreateFileStorage(fileStorageConfig, {MakeYtDownloader(fileStorageConfig)}));
             auto ytFileServices = NYql::NFile::TYtFileServices::Make(RunnerOptions.YdbSettings.FunctionRegistry.Get(), TablesMapping, fileStorage);
@@ -785,6 +2628,8 @@ protected:
             RunnerOptions.YdbSettings.ComputationFactory = NYql::NFile::GetYtFileFactory(ytFileServices);
         } else if (!TablesMapping.empty()) {
             ythrow yexception() << "Tables mapping is not supported without emulate YT mode";
+        } else if (PrefetchYtTables) {
+            ythrow yexception() << "Prefetch tables is not supported without emulate YT mode";
         }
 
         RunScript(ExecutionOptions, RunnerOptions);
@@ -0,0 +1,433 @@
+#include "latency_stats.h"
+
+#include <library/cpp/colorizer/colors.h>
+
+#include <util/string/printf.h>
+
+#include <algorithm>
+
+#include <sys/resource.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+constexpr i64 LOWEST_TRACKABLE_LATENCY_US = 1;
+constexpr i64 HIGHEST_TRACKABLE_LATENCY_US = TDuration::Hours(1).MicroSeconds();
+constexpr i32 SIGNIFICANT_DIGITS = 3;
+
+const std::vector<std::pair<TString, double>> REPORTED_PERCENTILES = {
+    {"p50", 50.0},
+    {"p90", 90.0},
+    {"p99", 99.0},
+    {"p99.9", 99.9}
+};
+
+TString FormatMs(TDuration duration) {
+    return Sprintf("%.3f", duration.MicroSeconds() / 1000.0);
+}
+
+TDuration ToDuration(const timeval& time) {
+    return TDuration::Seconds(time.tv_sec) + TDuration::MicroSeconds(time.tv_usec);
+}
+
+// User and system time of all process threads, client and embedded cluster share one process
+TDuration GetProcessCpuTime() {
+    rusage usage;
+    Y_ABORT_UNLESS(getrusage(RUSAGE_SELF, &usage) == 0);
+    return ToDuration(usage.ru_utime) + ToDuration(usage.ru_stime);
+}
+
+void PrintServerDurations(const TString& title, const TLatencyHistogram& durations, IOutputStream& output) {
+    output << title << ": count " << durations.GetCount();
+    for (const auto& [name, percentile] : REPORTED_PERCENTILES) {
+        output << ", " << name << " " << FormatMs(durations.GetPercentile(percentile));
+    }
+    output << ", max " << FormatMs(durations.GetMax()) << Endl;
+}
+
+}  // anonymous namespace
+
+//// TLatencyHistogram
+
+TLatencyHistogram::TLatencyHistogram()
+    : Histogram(MakeHolder<NHdr::THistogram>(LOWEST_TRACKABLE_LATENCY_US, HIGHEST_TRACKABLE_LATENCY_US, SIGNIFICANT_DIGITS))
+{}
+
+void TLatencyHistogram::Record(TDuration latency) {
+    const i64 value = std::clamp<i64>(latency.MicroSeconds(), LOWEST_TRACKABLE_LATENCY_US, HIGHEST_TRACKABLE_LATENCY_US);
+    Histogram->RecordValue(value);
+}
+
+void TLatencyHistogram::Merge(const TLatencyHistogram& other) {
+    Histogram->Add(*other.Histogram);
+}
+
+ui64 TLatencyHistogram::GetCount() const {
+    return Histogram->GetTotalCount();
+}
+
+TDuration TLatencyHistogram::GetPercentile(double percentile) const {
+    if (!GetCount()) {
+        return TDuration::Zero();
+    }
+    return TDuration::MicroSeconds(Histogram->GetValueAtPercentile(percentile));
+}
+
+TDuration TLatencyHistogram::GetMax() const {
+    if (!GetCount()) {
+        return TDuration::Zero();
+    }
+    return TDuration::MicroSeconds(Histogram->GetMax());
+}
+
+TDuration TLatencyHistogram::GetMean() const {
+    if (!GetCount()) {
+        return TDuration::Zero();
+    }
+    return TDuration::MicroSeconds(Histogram->GetMean());
+}
+
+NJson::TJsonValue TLatencyHistogram::ToJson() const {
+    NJson::TJsonValue result(NJson::JSON_MAP);
+    result["count"] = GetCount();
+    result["mean_us"] = GetMean().MicroSeconds();
+    for (const auto& [name, percentile] : REPORTED_PERCENTILES) {
+        result[name + "_us"] = GetPercentile(percentile).MicroSeconds();
+    }
+    result["max_us"] = GetMax().MicroSeconds();
+    return result;
+}
+
+//// TQueryLatencyStats
+
+TQueryLatencyStats::TQueryLatencyStats(std::vector<TQueryInfo> queries) {
+    Queries.reserve(queries.size());
+    for (auto& info : queries) {
+        Queries.push_back({.Info = std::move(info)});
+    }
+}
+
+void TQueryLatencyStats::StartRun(TInstant startTime) {
+    StartTime = startTime;
+    StartCpuTime = GetProcessCpuTime();
+}
+
+void TQueryLatencyStats::FinishRun(TInstant finishTime) {
+    FinishTime = finishTime;
+    FinishCpuTime = GetProcessCpuTime();
+}
+
+void TQueryLatencyStats::RecordSuccess(size_t index, TDuration latency) {
+    Y_ABORT_UNLESS(index < Queries.size());
+    auto& query = Queries[index];
+    query.Latencies.Record(latency);
+    if (KeepSamples) {
+        query.SamplesUs.emplace_back(latency.MicroSeconds());
+    }
+}
+
+void TQueryLatencyStats::RecordFailure(size_t index) {
+    Y_ABORT_UNLESS(index < Queries.size());
+    Queries[index].Failed++;
+}
+
+void TQueryLatencyStats::RecordFetch(size_t index, TDuration fetchTime, std::optional<ui64> resultRows, std::optional<ui64> resultBytes) {
+    Y_ABORT_UNLESS(index < Queries.size());
+    auto& query = Queries[index];
+    query.FetchLatencies.Record(fetchTime);
+    if (resultBytes) {
+        query.SizedFetchTime += fetchTime;
+        query.FetchedBytes += *resultBytes;
+        if (resultRows) {
+            query.FetchedRows = query.FetchedRows.value_or(0) + *resultRows;
+        }
+    }
+}
+
+void TQueryLatencyStats::RecordCompilation(size_t index, bool fromCache, TDuration compilationTime, TDuration executionTime) {
+    Y_ABORT_UNLESS(index < Queries.size());
+    auto& query = Queries[index];
+    if (fromCache) {
+        query.CompileCacheHits++;
+    } else {
+        query.CompileCacheMisses++;
+    }
+    query.CompilationLatencies.Record(compilationTime);
+    query.ExecutionLatencies.Record(executionTime);
+}
+
+void TQueryLatencyStats::RecordAdmissionWait(size_t index, TDuration wait, bool estimated) {
+    Y_ABORT_UNLESS(index < Queries.size());
+    auto& query = Queries[index];
+    query.AdmissionWaits.Record(wait);
+    query.EstimatedAdmissionWaits += estimated;
+}
+
+void TQueryLatencyStats::RecordAsyncServerDuration(std::optional<size_t> index, TDuration duration) {
+    if (!index) {
+        AsyncServerDurations.Record(duration);
+        return;
+    }
+    Y_ABORT_UNLESS(*index < Queries.size());
+    Queries[*index].ServerDurations.Record(duration);
+}
+
+void TQueryLatencyStats::RecordClientOverhead(TDuration overhead) {
+    ClientOverheads.Record(overhead);
+}
+
+void TQueryLatencyStats::EnableSamples() {
+    KeepSamples = true;
+}
+
+void TQueryLatencyStats::EnableSchedule(TDuration behindScheduleThreshold) {
+    Schedule = TScheduleStats{.BehindScheduleThreshold = behindScheduleThreshold};
+}
+
+void TQueryLatencyStats::RecordSendLag(TDuration lag) {
+    Y_ABORT_UNLESS(Schedule);
+    Schedule->SendLags.Record(lag);
+    if (lag > Schedule->BehindScheduleThreshold) {
+        Schedule->BehindSchedule++;
+    }
+}
+
+void TQueryLatencyStats::EnableTimeouts() {
+    Timeouts = TTimeoutStats();
+}
+
+void TQueryLatencyStats::RecordTimeout(TDuration timeout, TDuration elapsed, bool success) {
+    Y_ABORT_UNLESS(Timeouts);
+    if (success) {
+        Timeouts->Completed++;
+    } else if (elapsed < timeout) {
+        Timeouts->FailedBeforeTimeout++;
+    } else {
+        Timeouts->FailedAfterTimeout.Record(elapsed - timeout);
+    }
+}
+
+double TQueryLatencyStats::GetCpuCores() const {
+    const TDuration duration = FinishTime - StartTime;
+    if (!duration) {
+        return 0.0;
+    }
+    return (FinishCpuTime - StartCpuTime).SecondsFloat() / duration.SecondsFloat();
+}
+
+double TQueryLatencyStats::GetQps(ui64 count) const {
+    const TDuration duration = FinishTime - StartTime;
+    if (!duration) {
+        return 0.0;
+    }
+    return count / duration.SecondsFloat();
+}
+
+std::map<TString, TQueryLatencyStats::TQueryStats> TQueryLatencyStats::GetPoolStats() const {
+    std::map<TString, TQueryStats> pools;
+    for (const auto& query : Queries) {
+        if (!query.Info.PoolId) {
+            continue;
+        }
+        auto& pool = pools[query.Info.PoolId];
+        pool.Info.PoolId = query.Info.PoolId;
+        pool.Latencies.Merge(query.Latencies);
+        pool.Failed += query.Failed;
+        pool.AdmissionWaits.Merge(query.AdmissionWaits);
+        pool.EstimatedAdmissionWaits += query.EstimatedAdmissionWaits;
+    }
+    return pools;
+}
+
+NJson::TJsonValue TQueryLatencyStats::ToJson() const {
+    NJson::TJsonValue result(NJson::JSON_MAP);
+    result["duration_us"] = (FinishTime - StartTime).MicroSeconds();
+    result["process_cpu_us"] = (FinishCpuTime - StartCpuTime).MicroSeconds();
+    result["process_cpu_cores"] = GetCpuCores();
+
+    TLatencyHistogram total;
+    ui64 totalFailed = 0;
+    auto& queries = result["queries"];
+    queries.SetType(NJson::JSON_ARRAY);
+    for (size_t i = 0; i < Queries.size(); ++i) {
+        const auto& query = Queries[i];
+        auto& queryJson = queries.AppendValue(query.Latencies.ToJson());
+        queryJson["index"] = i;
+        queryJson["name"] = query.Info.Name;
+        queryJson["pool"] = query.Info.PoolId;
+        queryJson["latency_kind"] = query.Info.SubmitLatency ? "submit" : "complete";
+        queryJson["failed"] = query.Failed;
+        queryJson["qps"] = GetQps(query.Latencies.GetCount());
+        if (query.ServerDurations.GetCount()) {
+            queryJson["server_duration"] = query.ServerDurations.ToJson();
+        }
+        if (query.FetchLatencies.GetCount()) {
+            auto& fetchJson = queryJson["fetch"];
+            fetchJson = query.FetchLatencies.ToJson();
+            if (const TDuration fetchTime = query.SizedFetchTime) {
+                if (const auto rows = query.FetchedRows) {
+                    fetchJson["rows"] = *rows;
+                    fetchJson["rows_per_second"] = *rows / fetchTime.SecondsFloat();
+                }
+                fetchJson["bytes"] = query.FetchedBytes;
+                fetchJson["bytes_per_second"] = query.FetchedBytes / fetchTime.SecondsFloat();
+            }
+        }
+        if (query.AdmissionWaits.GetCount()) {
+            queryJson["admission_wait"] = query.AdmissionWaits.ToJson();
+            queryJson["admission_wait"]["estimated"] = query.EstimatedAdmissionWaits;
+        }
+        if (query.CompilationLatencies.GetCount()) {
+            auto& compilationJson = queryJson["compilation"];
+            compilationJson["cache_hits"] = query.CompileCacheHits;
+            compilationJson["cache_misses"] = query.CompileCacheMisses;
+            compilationJson["compile"] = query.CompilationLatencies.ToJson();
+            compilationJson["execute"] = query.ExecutionLatencies.ToJson();
+        }
+        if (KeepSamples) {
+            auto& samples = queryJson["samples_us"];
+            samples.SetType(NJson::JSON_ARRAY);
+            for (const ui64 sample : query.SamplesUs) {
+                samples.AppendValue(sample);
+            }
+        }
+
+        total.Merge(query.Latencies);
+        totalFailed += query.Failed;
+    }
+
+    result["total"] = total.ToJson();
+    result["total"]["failed"] = totalFailed;
+    result["total"]["qps"] = GetQps(total.GetCount());
+
+    auto& poolsJson = result["pools"];
+    poolsJson.SetType(NJson::JSON_MAP);
+    for (const auto& [poolId, pool] : GetPoolStats()) {
+        auto& poolJson = poolsJson[poolId];
+        poolJson = pool.Latencies.ToJson();
+        // Rejected by pool queries can not be distinguished from other failures
+        poolJson["failed"] = pool.Failed;
+        poolJson["qps"] = GetQps(pool.Latencies.GetCount());
+        if (pool.AdmissionWaits.GetCount()) {
+            poolJson["admission_wait"] = pool.AdmissionWaits.ToJson();
+            poolJson["admission_wait"]["estimated"] = pool.EstimatedAdmissionWaits;
+        }
+    }
+
+    if (Schedule) {
+        auto& scheduleJson = result["schedule"];
+        scheduleJson["send_lag"] = Schedule->SendLags.ToJson();
+        scheduleJson["behind_schedule"] = Schedule->BehindSchedule;
+        scheduleJson["behind_schedule_threshold_us"] = Schedule->BehindScheduleThreshold.MicroSeconds();
+    }
+
+    if (Timeouts) {
+        auto& timeoutsJson = result["timeouts"];
+        timeoutsJson["failed_after_timeout"] = Timeouts->FailedAfterTimeout.ToJson();
+        timeoutsJson["completed"] = Timeouts->Completed;
+        timeoutsJson["failed_before_timeout"] = Timeouts->FailedBeforeTimeout;
+    }
+
+    if (AsyncServerDurations.GetCount()) {
+        result["async_server_duration"] = AsyncServerDurations.ToJson();
+    }
+
+    if (ClientOverheads.GetCount()) {
+        result["client_overhead"] = ClientOverheads.ToJson();
+    }
+    return result;
+}
+
+void TQueryLatencyStats::PrintSummary(IOutputStream& output) const {
+    NColorizer::TColors colors = NColorizer::AutoColors(output);
+
+    output << colors.Cyan() << "Latency statistics (ms), run duration " << FormatMs(FinishTime - StartTime);
+    output << ", process cpu cores " << Sprintf("%.2f", GetCpuCores()) << colors.Default() << Endl;
+    for (size_t i = 0; i < Queries.size(); ++i) {
+        const auto& query = Queries[i];
+        const auto& latencies = query.Latencies;
+        output << "  " << query.Info.Name << (query.Info.SubmitLatency ? " (submit)" : "")
+            << ": count " << latencies.GetCount()
+            << ", failed " << query.Failed
+            << ", qps " << Sprintf("%.2f", GetQps(latencies.GetCount()));
+        for (const auto& [name, percentile] : REPORTED_PERCENTILES) {
+            output << ", " << name << " " << FormatMs(latencies.GetPercentile(percentile));
+        }
+        output << ", max " << FormatMs(latencies.GetMax()) << Endl;
+
+        if (query.ServerDurations.GetCount()) {
+            PrintServerDurations("    server duration", query.ServerDurations, output);
+        }
+
+        if (const auto& fetches = query.FetchLatencies; fetches.GetCount()) {
+            output << "    fetch: p50 " << FormatMs(fetches.GetPercentile(50.0))
+                << ", p99 " << FormatMs(fetches.GetPercentile(99.0))
+                << ", max " << FormatMs(fetches.GetMax());
+            if (const TDuration fetchTime = query.SizedFetchTime) {
+                if (const auto rows = query.FetchedRows) {
+                    output << ", rows/s " << Sprintf("%.0f", *rows / fetchTime.SecondsFloat());
+                }
+                output << ", MB/s " << Sprintf("%.2f", query.FetchedBytes / 1048576.0 / fetchTime.SecondsFloat());
+            }
+            output << Endl;
+        }
+
+        if (const auto& compilations = query.CompilationLatencies; compilations.GetCount()) {
+            const auto& executions = query.ExecutionLatencies;
+            output << "    compile: cache hits " << query.CompileCacheHits
+                << ", misses " << query.CompileCacheMisses
+                << ", p50 " << FormatMs(compilations.GetPercentile(50.0))
+                << ", p99 " << FormatMs(compilations.GetPercentile(99.0))
+                << ", execute p50 " << FormatMs(executions.GetPercentile(50.0))
+                << ", p99 " << FormatMs(executions.GetPercentile(99.0)) << Endl;
+        }
+    }
+
+    for (const auto& [poolId, pool] : GetPoolStats()) {
+        output << "  pool " << poolId
+            << ": count " << pool.Latencies.GetCount()
+            << ", failed " << pool.Failed
+            << ", qps " << Sprintf("%.2f", GetQps(pool.Latencies.GetCount()))
+            << ", p50 " << FormatMs(pool.Latencies.GetPercentile(50.0))
+            << ", p99 " << FormatMs(pool.Latencies.GetPercentile(99.0));
+        if (const auto& waits = pool.AdmissionWaits; waits.GetCount()) {
+            output << ", admission wait" << (pool.EstimatedAdmissionWaits ? " (estimated)" : "")
+                << " p50 " << FormatMs(waits.GetPercentile(50.0))
+                << ", p99 " << FormatMs(waits.GetPercentile(99.0));
+        }
+        output << Endl;
+    }
+
+    if (Schedule) {
+        const auto& lags = Schedule->SendLags;
+        output << "  schedule: requests " << lags.GetCount()
+            << ", behind schedule " << Schedule->BehindSchedule
+            << ", send lag p99 " << FormatMs(lags.GetPercentile(99.0))
+            << ", send lag max " << FormatMs(lags.GetMax()) << Endl;
+    }
+
+    if (Timeouts) {
+        const auto& late = Timeouts->FailedAfterTimeout;
+        output << "  timeouts: failed after timeout " << late.GetCount()
+            << ", completed " << Timeouts->Completed
+            << ", failed before timeout " << Timeouts->FailedBeforeTimeout;
+        for (const auto& [name, percentile] : REPORTED_PERCENTILES) {
+            output << ", past timeout " << name << " " << FormatMs(late.GetPercentile(percentile));
+        }
+        output << ", past timeout max " << FormatMs(late.GetMax()) << Endl;
+    }
+
+    if (AsyncServerDurations.GetCount()) {
+        PrintServerDurations("  async queries server duration", AsyncServerDurations, output);
+    }
+
+    if (ClientOverheads.GetCount()) {
+        output << "  client overhead: mean " << FormatMs(ClientOverheads.GetMean())
+            << ", p99 " << FormatMs(ClientOverheads.GetPercentile(99.0))
+            << ", max " << FormatMs(ClientOverheads.GetMax()) << Endl;
+    }
+}
+
+}  // namespace NKqpRun
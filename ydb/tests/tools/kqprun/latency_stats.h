@@ -0,0 +1,145 @@
+#pragma once
+
+#include <library/cpp/histogram/hdr/histogram.h>
+#include <library/cpp/json/json_value.h>
+
+#include <util/datetime/base.h>
+#include <util/generic/ptr.h>
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+
+#include <map>
+#include <optional>
+#include <vector>
+
+
+namespace NKqpRun {
+
+class TLatencyHistogram {
+public:
+    TLatencyHistogram();
+
+    void Record(TDuration latency);
+    void Merge(const TLatencyHistogram& other);
+
+    ui64 GetCount() const;
+    TDuration GetPercentile(double percentile) const;
+    TDuration GetMax() const;
+    TDuration GetMean() const;
+
+    NJson::TJsonValue ToJson() const;
+
+private:
+    THolder<NHdr::THistogram> Histogram;
+};
+
+// Collects latencies of -p queries over all loop steps, one histogram per script index
+class TQueryLatencyStats {
+public:
+    struct TQueryInfo {
+        TString Name;
+        // For async queries only time spent in submission is visible on the client side,
+        // server side duration is known only from query plan
+        bool SubmitLatency = false;
+        // Workload manager pool, queries from one pool are also aggregated together
+        TString PoolId;
+    };
+
+    explicit TQueryLatencyStats(std::vector<TQueryInfo> queries);
+
+    // Process CPU time is also measured between start and finish of run
+    void StartRun(TInstant startTime);
+    void FinishRun(TInstant finishTime);
+
+    void RecordSuccess(size_t index, TDuration latency);
+    void RecordFailure(size_t index);
+
+    // Time of FetchScriptResults for generic scripts, result size is known only if fetched results are measured
+    void RecordFetch(size_t index, TDuration fetchTime, std::optional<ui64> resultRows, std::optional<ui64> resultBytes);
+
+    // Compilation statistics from query plan, execution time is the rest of query duration
+    void RecordCompilation(size_t index, bool fromCache, TDuration compilationTime, TDuration executionTime);
+
+    // Wait for admission in workload manager pool, estimated wait is client latency
+    // not covered by server side query duration
+    void RecordAdmissionWait(size_t index, TDuration wait, bool estimated);
+
+    // Server side duration (TotalDurationUs) of async query from its plan printed on completion, it does not
+    // include queueing of request in runner, so it is not client completion latency. Plans can be matched
+    // with query only if script has one query, otherwise duration is accounted in total
+    void RecordAsyncServerDuration(std::optional<size_t> index, TDuration duration);
+
+    // Time spent by kqprun itself in loop step, outside of runner calls
+    void RecordClientOverhead(TDuration overhead);
+
+    // Keep all latencies to write them into report, used for statistical comparison of runs
+    void EnableSamples();
+
+    // Open-loop mode, delay of each submission from its scheduled send time is measured,
+    // query latencies are still submission latencies, server durations are known only from async query plans
+    void EnableSchedule(TDuration behindScheduleThreshold);
+    void RecordSendLag(TDuration lag);
+
+    // Randomized timeouts mode, failure status is not visible from runner, so failures responded
+    // after deadline are treated as timed out and their delay past deadline is measured
+    void EnableTimeouts();
+    void RecordTimeout(TDuration timeout, TDuration elapsed, bool success);
+
+    NJson::TJsonValue ToJson() const;
+    void PrintSummary(IOutputStream& output) const;
+
+private:
+    struct TQueryStats {
+        TQueryInfo Info;
+        TLatencyHistogram Latencies;
+        TLatencyHistogram ServerDurations;
+        ui64 Failed = 0;
+        std::vector<ui64> SamplesUs;
+
+        TLatencyHistogram FetchLatencies;
+        // Only for fetches with known result size
+        TDuration SizedFetchTime;
+        // Rows are not known for some result formats
+        std::optional<ui64> FetchedRows;
+        ui64 FetchedBytes = 0;
+
+        ui64 CompileCacheHits = 0;
+        ui64 CompileCacheMisses = 0;
+        TLatencyHistogram CompilationLatencies;
+        TLatencyHistogram ExecutionLatencies;
+
+        TLatencyHistogram AdmissionWaits;
+        ui64 EstimatedAdmissionWaits = 0;
+    };
+
+    struct TScheduleStats {
+        TDuration BehindScheduleThreshold;
+        TLatencyHistogram SendLags;
+        ui64 BehindSchedule = 0;
+    };
+
+    struct TTimeoutStats {
+        TLatencyHistogram FailedAfterTimeout;
+        ui64 Completed = 0;
+        ui64 FailedBeforeTimeout = 0;
+    };
+
+    double GetQps(ui64 count) const;
+    double GetCpuCores() const;
+    std::map<TString, TQueryStats> GetPoolStats() const;
+
+private:
+    std::vector<TQueryStats> Queries;
+    std::optional<TScheduleStats> Schedule;
+    std::optional<TTimeoutStats> Timeouts;
+    // Server durations of async queries which are not matched with query
+    TLatencyHistogram AsyncServerDurations;
+    TLatencyHistogram ClientOverheads;
+    bool KeepSamples = false;
+    TInstant StartTime;
+    TInstant FinishTime;
+    TDuration StartCpuTime;
+    TDuration FinishCpuTime;
+};
+
+}  // namespace NKqpRun
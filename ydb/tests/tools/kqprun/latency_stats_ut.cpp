@@ -0,0 +1,180 @@
+#include "latency_stats.h"
+
+#include <library/cpp/testing/unittest/registar.h>
+
+
+namespace NKqpRun {
+
+Y_UNIT_TEST_SUITE(LatencyHistogram) {
+    Y_UNIT_TEST(Empty) {
+        TLatencyHistogram histogram;
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetCount(), 0);
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetPercentile(50.0), TDuration::Zero());
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetMax(), TDuration::Zero());
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetMean(), TDuration::Zero());
+    }
+
+    Y_UNIT_TEST(Percentiles) {
+        // Values below 2048us are stored exactly with three significant digits
+        TLatencyHistogram histogram;
+        for (ui64 i = 1; i <= 1000; ++i) {
+            histogram.Record(TDuration::MicroSeconds(i));
+        }
+
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetCount(), 1000);
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetPercentile(50.0), TDuration::MicroSeconds(500));
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetPercentile(90.0), TDuration::MicroSeconds(900));
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetPercentile(99.0), TDuration::MicroSeconds(990));
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetPercentile(99.9), TDuration::MicroSeconds(999));
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetMax(), TDuration::MicroSeconds(1000));
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetMean(), TDuration::MicroSeconds(500));
+
+        const auto json = histogram.ToJson();
+        UNIT_ASSERT_VALUES_EQUAL(json["count"].GetUInteger(), 1000);
+        UNIT_ASSERT_VALUES_EQUAL(json["p50_us"].GetUInteger(), 500);
+        UNIT_ASSERT_VALUES_EQUAL(json["p90_us"].GetUInteger(), 900);
+        UNIT_ASSERT_VALUES_EQUAL(json["p99_us"].GetUInteger(), 990);
+        UNIT_ASSERT_VALUES_EQUAL(json["p99.9_us"].GetUInteger(), 999);
+        UNIT_ASSERT_VALUES_EQUAL(json["max_us"].GetUInteger(), 1000);
+    }
+
+    Y_UNIT_TEST(Precision) {
+        TLatencyHistogram histogram;
+        histogram.Record(TDuration::Seconds(1));
+
+        const double value = histogram.GetPercentile(50.0).MicroSeconds();
+        UNIT_ASSERT_DOUBLES_EQUAL(value, 1'000'000.0, 1'000.0);
+    }
+
+    Y_UNIT_TEST(Clamping) {
+        TLatencyHistogram histogram;
+        histogram.Record(TDuration::Zero());
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetMax(), TDuration::MicroSeconds(1));
+
+        histogram.Record(TDuration::Hours(2));
+        UNIT_ASSERT_VALUES_EQUAL(histogram.GetCount(), 2);
+        UNIT_ASSERT_DOUBLES_EQUAL(histogram.GetMax().SecondsFloat(), TDuration::Hours(1).SecondsFloat(), 4.0);
+    }
+
+    Y_UNIT_TEST(Merge) {
+        TLatencyHistogram first;
+        TLatencyHistogram second;
+        for (ui64 i = 1; i <= 10; ++i) {
+            first.Record(TDuration::MicroSeconds(i));
+            second.Record(TDuration::MicroSeconds(100 + i));
+        }
+
+        first.Merge(second);
+        UNIT_ASSERT_VALUES_EQUAL(first.GetCount(), 20);
+        UNIT_ASSERT_VALUES_EQUAL(first.GetPercentile(50.0), TDuration::MicroSeconds(10));
+        UNIT_ASSERT_VALUES_EQUAL(first.GetMax(), TDuration::MicroSeconds(110));
+        UNIT_ASSERT_VALUES_EQUAL(second.GetCount(), 10);
+    }
+}
+
+Y_UNIT_TEST_SUITE(QueryLatencyStats) {
+    TQueryLatencyStats MakeStats() {
+        return TQueryLatencyStats({
+            {.Name = "select"},
+            {.Name = "insert", .SubmitLatency = true, .PoolId = "pool"}
+        });
+    }
+
+    Y_UNIT_TEST(Queries) {
+        auto stats = MakeStats();
+        stats.StartRun(TInstant::Seconds(100));
+        for (ui64 i = 1; i <= 3; ++i) {
+            stats.RecordSuccess(0, TDuration::MilliSeconds(i));
+        }
+        stats.RecordFailure(0);
+        stats.RecordSuccess(1, TDuration::MilliSeconds(10));
+        stats.FinishRun(TInstant::Seconds(102));
+
+        const auto json = stats.ToJson();
+        UNIT_ASSERT_VALUES_EQUAL(json["duration_us"].GetUInteger(), 2'000'000);
+
+        const auto& select = json["queries"][0];
+        UNIT_ASSERT_VALUES_EQUAL(select["name"].GetString(), "select");
+        UNIT_ASSERT_VALUES_EQUAL(select["latency_kind"].GetString(), "complete");
+        UNIT_ASSERT_VALUES_EQUAL(select["count"].GetUInteger(), 3);
+        UNIT_ASSERT_VALUES_EQUAL(select["failed"].GetUInteger(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(select["p50_us"].GetUInteger(), 2000);
+        UNIT_ASSERT_VALUES_EQUAL(select["max_us"].GetUInteger(), 3000);
+        UNIT_ASSERT_DOUBLES_EQUAL(select["qps"].GetDouble(), 1.5, 1e-9);
+
+        const auto& insert = json["queries"][1];
+        UNIT_ASSERT_VALUES_EQUAL(insert["latency_kind"].GetString(), "submit");
+        UNIT_ASSERT_VALUES_EQUAL(insert["pool"].GetString(), "pool");
+        UNIT_ASSERT(!insert.Has("server_duration"));
+
+        UNIT_ASSERT_VALUES_EQUAL(json["total"]["count"].GetUInteger(), 4);
+        UNIT_ASSERT_VALUES_EQUAL(json["total"]["failed"].GetUInteger(), 1);
+        UNIT_ASSERT_DOUBLES_EQUAL(json["total"]["qps"].GetDouble(), 2.0, 1e-9);
+
+        // Only queries with pool are aggregated by pools
+        UNIT_ASSERT_VALUES_EQUAL(json["pools"].GetMap().size(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(json["pools"]["pool"]["count"].GetUInteger(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(json["pools"]["pool"]["max_us"].GetUInteger(), 10'000);
+    }
+
+    Y_UNIT_TEST(Samples) {
+        auto stats = MakeStats();
+        stats.EnableSamples();
+        stats.RecordSuccess(0, TDuration::MicroSeconds(7));
+        stats.RecordSuccess(0, TDuration::MicroSeconds(3));
+
+        const auto& samples = stats.ToJson()["queries"][0]["samples_us"].GetArray();
+        UNIT_ASSERT_VALUES_EQUAL(samples.size(), 2);
+        UNIT_ASSERT_VALUES_EQUAL(samples[0].GetUInteger(), 7);
+        UNIT_ASSERT_VALUES_EQUAL(samples[1].GetUInteger(), 3);
+    }
+
+    Y_UNIT_TEST(Timeouts) {
+        auto stats = MakeStats();
+        stats.EnableTimeouts();
+        const TDuration timeout = TDuration::MilliSeconds(10);
+        stats.RecordTimeout(timeout, TDuration::MilliSeconds(5), true);
+        stats.RecordTimeout(timeout, TDuration::MilliSeconds(5), false);
+        stats.RecordTimeout(timeout, TDuration::MilliSeconds(15), false);
+
+        const auto& timeouts = stats.ToJson()["timeouts"];
+        UNIT_ASSERT_VALUES_EQUAL(timeouts["completed"].GetUInteger(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(timeouts["failed_before_timeout"].GetUInteger(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(timeouts["failed_after_timeout"]["count"].GetUInteger(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(timeouts["failed_after_timeout"]["max_us"].GetUInteger(), 5000);
+    }
+
+    Y_UNIT_TEST(Compilation) {
+        auto stats = MakeStats();
+        stats.RecordCompilation(0, false, TDuration::MilliSeconds(5), TDuration::MilliSeconds(1));
+        stats.RecordCompilation(0, true, TDuration::MicroSeconds(100), TDuration::MilliSeconds(1));
+        stats.RecordCompilation(0, true, TDuration::MicroSeconds(100), TDuration::MilliSeconds(1));
+
+        const auto& compilation = stats.ToJson()["queries"][0]["compilation"];
+        UNIT_ASSERT_VALUES_EQUAL(compilation["cache_hits"].GetUInteger(), 2);
+        UNIT_ASSERT_VALUES_EQUAL(compilation["cache_misses"].GetUInteger(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(compilation["compile"]["p50_us"].GetUInteger(), 100);
+        UNIT_ASSERT_VALUES_EQUAL(compilation["execute"]["count"].GetUInteger(), 3);
+    }
+
+    Y_UNIT_TEST(AsyncServerDurations) {
+        auto stats = MakeStats();
+        stats.StartRun(TInstant::Seconds(100));
+        stats.RecordSuccess(1, TDuration::MicroSeconds(50));
+        stats.RecordAsyncServerDuration(1, TDuration::MilliSeconds(2));
+        stats.RecordAsyncServerDuration(std::nullopt, TDuration::MilliSeconds(30));
+        stats.RecordAsyncServerDuration(std::nullopt, TDuration::MilliSeconds(40));
+        stats.FinishRun(TInstant::Seconds(101));
+
+        const auto json = stats.ToJson();
+        const auto& serverDuration = json["queries"][1]["server_duration"];
+        UNIT_ASSERT_VALUES_EQUAL(serverDuration["count"].GetUInteger(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(serverDuration["max_us"].GetUInteger(), 2000);
+        // Submission latency is kept as query latency
+        UNIT_ASSERT_VALUES_EQUAL(json["queries"][1]["max_us"].GetUInteger(), 50);
+
+        UNIT_ASSERT_VALUES_EQUAL(json["async_server_duration"]["count"].GetUInteger(), 2);
+    }
+}
+
+}  // namespace NKqpRun
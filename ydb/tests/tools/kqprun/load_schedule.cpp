@@ -0,0 +1,83 @@
+#include "load_schedule.h"
+
+#include <util/generic/yexception.h>
+#include <util/system/spinlock.h>
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace NKqpRun {
+
+namespace {
+
+constexpr TDuration SPIN_INTERVAL = TDuration::MicroSeconds(200);
+
+}  // anonymous namespace
+
+TRpsSchedule::TRpsSchedule(const TSettings& settings) {
+    if (settings.TargetRps <= 0.0) {
+        ythrow yexception() << "Target rps should be positive, got " << settings.TargetRps;
+    }
+
+    const double firstRps = settings.Steps.empty() ? settings.TargetRps : settings.Steps.front().Rps;
+    if (settings.RampUp) {
+        AddSegment(0.0, firstRps, settings.RampUp);
+    }
+    for (const auto& step : settings.Steps) {
+        if (step.Rps <= 0.0 || !step.Duration) {
+            ythrow yexception() << "Rps step should have positive rate and duration";
+        }
+        AddSegment(step.Rps, step.Rps, step.Duration);
+    }
+    AddSegment(settings.TargetRps, settings.TargetRps, TDuration::Zero());
+}
+
+void TRpsSchedule::AddSegment(double startRps, double finishRps, TDuration duration) {
+    TSegment segment = {
+        .StartRps = startRps,
+        .FinishRps = finishRps,
+        .Duration = duration
+    };
+    if (!Segments.empty()) {
+        const auto& previous = Segments.back();
+        segment.StartOffset = previous.StartOffset + previous.Duration;
+        segment.StartCount = previous.StartCount + previous.Duration.SecondsFloat() * (previous.StartRps + previous.FinishRps) / 2;
+    }
+    Segments.emplace_back(segment);
+}
+
+TDuration TRpsSchedule::GetSendOffset(ui64 requestNumber) const {
+    const double count = requestNumber;
+
+    size_t segmentId = 0;
+    while (segmentId + 1 < Segments.size() && Segments[segmentId + 1].StartCount <= count) {
+        ++segmentId;
+    }
+    const auto& segment = Segments[segmentId];
+
+    // Number of requests sent in segment until time t is StartRps * t + (FinishRps - StartRps) * t^2 / (2 * Duration)
+    const double k = count - segment.StartCount;
+    const double b = segment.StartRps;
+    const double a = segment.Duration ? (segment.FinishRps - segment.StartRps) / (2 * segment.Duration.SecondsFloat()) : 0.0;
+
+    double seconds = 0.0;
+    if (std::abs(a) > 1e-9) {
+        seconds = (-b + std::sqrt(std::max(b * b + 4 * a * k, 0.0))) / (2 * a);
+    } else if (b > 0.0) {
+        seconds = k / b;
+    }
+    return segment.StartOffset + TDuration::MicroSeconds(static_cast<ui64>(seconds * 1'000'000));
+}
+
+void WaitUntil(TInstant deadline) {
+    const TInstant now = TInstant::Now();
+    if (deadline > now + SPIN_INTERVAL) {
+        Sleep(deadline - now - SPIN_INTERVAL);
+    }
+    while (TInstant::Now() < deadline) {
+        SpinLockPause();
+    }
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <util/datetime/base.h>
+
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Open-loop request schedule: linear ramp up, then constant rate steps, then target rate forever
+class TRpsSchedule {
+public:
+    struct TStep {
+        double Rps = 0.0;
+        TDuration Duration;
+    };
+
+    struct TSettings {
+        double TargetRps = 0.0;
+        TDuration RampUp;
+        std::vector<TStep> Steps;
+    };
+
+    explicit TRpsSchedule(const TSettings& settings);
+
+    // Offset from schedule start at which request with given number should be sent
+    TDuration GetSendOffset(ui64 requestNumber) const;
+
+private:
+    struct TSegment {
+        double StartRps = 0.0;
+        double FinishRps = 0.0;
+        TDuration Duration;  // Zero for the last infinite segment
+        TDuration StartOffset;
+        double StartCount = 0.0;
+    };
+
+    void AddSegment(double startRps, double finishRps, TDuration duration);
+
+private:
+    std::vector<TSegment> Segments;
+};
+
+// Sleeps until deadline, the last part of interval is spinned to keep send time precise
+void WaitUntil(TInstant deadline);
+
+}  // namespace NKqpRun
@@ -0,0 +1,85 @@
+#include "load_schedule.h"
+
+#include <library/cpp/testing/unittest/registar.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+// Offsets are computed in floating point and truncated to microseconds
+void AssertOffset(const TRpsSchedule& schedule, ui64 requestNumber, TDuration expected) {
+    const double offset = schedule.GetSendOffset(requestNumber).MicroSeconds();
+    UNIT_ASSERT_DOUBLES_EQUAL_C(offset, expected.MicroSeconds(), 1.0, "request " << requestNumber);
+}
+
+}  // anonymous namespace
+
+Y_UNIT_TEST_SUITE(RpsSchedule) {
+    Y_UNIT_TEST(ConstantRate) {
+        const TRpsSchedule schedule({.TargetRps = 100.0});
+        AssertOffset(schedule, 0, TDuration::Zero());
+        AssertOffset(schedule, 1, TDuration::MilliSeconds(10));
+        AssertOffset(schedule, 50, TDuration::MilliSeconds(500));
+        AssertOffset(schedule, 1000, TDuration::Seconds(10));
+    }
+
+    Y_UNIT_TEST(RampUp) {
+        // Rate grows linearly from 0 to 100 rps over 10s, so 5 * t^2 requests are sent until t
+        const TRpsSchedule schedule({.TargetRps = 100.0, .RampUp = TDuration::Seconds(10)});
+        AssertOffset(schedule, 5, TDuration::Seconds(1));
+        AssertOffset(schedule, 125, TDuration::Seconds(5));
+        AssertOffset(schedule, 500, TDuration::Seconds(10));
+        AssertOffset(schedule, 600, TDuration::Seconds(11));
+    }
+
+    Y_UNIT_TEST(Steps) {
+        const TRpsSchedule schedule({
+            .TargetRps = 100.0,
+            .Steps = {
+                {.Rps = 10.0, .Duration = TDuration::Seconds(2)},
+                {.Rps = 50.0, .Duration = TDuration::Seconds(1)}
+            }
+        });
+        AssertOffset(schedule, 10, TDuration::Seconds(1));
+        AssertOffset(schedule, 20, TDuration::Seconds(2));
+        AssertOffset(schedule, 45, TDuration::MilliSeconds(2500));
+        AssertOffset(schedule, 70, TDuration::Seconds(3));
+        AssertOffset(schedule, 170, TDuration::Seconds(4));
+    }
+
+    Y_UNIT_TEST(RampUpToFirstStep) {
+        // Ramp up goes to the first step rate: 10 requests in 2s, then 20 rps step, then 100 rps
+        const TRpsSchedule schedule({
+            .TargetRps = 100.0,
+            .RampUp = TDuration::Seconds(2),
+            .Steps = {{.Rps = 10.0, .Duration = TDuration::Seconds(1)}}
+        });
+        AssertOffset(schedule, 10, TDuration::Seconds(2));
+        AssertOffset(schedule, 15, TDuration::MilliSeconds(2500));
+        AssertOffset(schedule, 20, TDuration::Seconds(3));
+        AssertOffset(schedule, 120, TDuration::Seconds(4));
+    }
+
+    Y_UNIT_TEST(Monotonic) {
+        const TRpsSchedule schedule({
+            .TargetRps = 300.0,
+            .RampUp = TDuration::Seconds(3),
+            .Steps = {{.Rps = 200.0, .Duration = TDuration::Seconds(1)}}
+        });
+        TDuration previous;
+        for (ui64 i = 0; i < 2000; ++i) {
+            const TDuration offset = schedule.GetSendOffset(i);
+            UNIT_ASSERT_C(offset >= previous, "request " << i);
+            previous = offset;
+        }
+    }
+
+    Y_UNIT_TEST(InvalidSettings) {
+        UNIT_ASSERT_EXCEPTION_CONTAINS(TRpsSchedule({.TargetRps = 0.0}), yexception, "Target rps should be positive");
+        UNIT_ASSERT_EXCEPTION_CONTAINS(TRpsSchedule({.TargetRps = 10.0, .Steps = {{.Rps = 0.0, .Duration = TDuration::Seconds(1)}}}), yexception, "positive rate and duration");
+        UNIT_ASSERT_EXCEPTION_CONTAINS(TRpsSchedule({.TargetRps = 10.0, .Steps = {{.Rps = 5.0}}}), yexception, "positive rate and duration");
+    }
+}
+
+}  // namespace NKqpRun
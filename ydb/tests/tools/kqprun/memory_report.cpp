@@ -0,0 +1,135 @@
+#include "memory_report.h"
+
+#include <contrib/libs/tcmalloc/tcmalloc/malloc_extension.h>
+
+#include <library/cpp/colorizer/colors.h>
+
+#include <util/string/printf.h>
+
+#include <algorithm>
+
+#include <sys/resource.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+const std::vector<TString> TCMALLOC_PROPERTIES = {
+    "generic.current_allocated_bytes",
+    "generic.heap_size",
+    "generic.physical_memory_used",
+    "tcmalloc.pageheap_free_bytes",
+    "tcmalloc.pageheap_unmapped_bytes",
+    "tcmalloc.required_bytes"
+};
+
+TString FormatMb(ui64 bytes) {
+    return Sprintf("%.1f", bytes / 1048576.0);
+}
+
+}  // anonymous namespace
+
+void TMemoryReport::StartRun(const std::vector<TString>& queryNames) {
+    QueryNames = queryNames;
+    Queries.assign(QueryNames.size(), TQueryMemory());
+    ProcessStats = NJson::TJsonValue(NJson::JSON_MAP);
+}
+
+void TMemoryReport::AddQuery(size_t index, const std::vector<TStageStats>& stages) {
+    Y_ABORT_UNLESS(index < Queries.size());
+    if (stages.empty()) {
+        return;
+    }
+
+    auto& query = Queries[index];
+    query.Executions++;
+
+    ui64 peakMemory = 0;
+    ui64 spillingBytes = 0;
+    for (const auto& stage : stages) {
+        auto& stageMemory = query.Stages[stage.PlanNodeId];
+        stageMemory.Name = stage.Name;
+        stageMemory.MaxTaskMemory = std::max(stageMemory.MaxTaskMemory, stage.MaxMemoryUsage);
+        stageMemory.TotalMemory = std::max(stageMemory.TotalMemory, stage.TotalMemoryUsage);
+
+        peakMemory += stage.TotalMemoryUsage;
+        spillingBytes += stage.SpillingBytes;
+        query.MaxTaskMemory = std::max(query.MaxTaskMemory, stage.MaxMemoryUsage);
+    }
+    query.PeakMemory = std::max(query.PeakMemory, peakMemory);
+    query.SpillingBytes = std::max(query.SpillingBytes, spillingBytes);
+}
+
+void TMemoryReport::FinishRun() {
+    auto& tcmalloc = ProcessStats["tcmalloc"];
+    tcmalloc.SetType(NJson::JSON_MAP);
+    for (const auto& property : TCMALLOC_PROPERTIES) {
+        if (const auto value = tcmalloc::MallocExtension::GetNumericProperty(property)) {
+            tcmalloc[property] = *value;
+        }
+    }
+
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        ProcessStats["max_rss_bytes"] = static_cast<ui64>(usage.ru_maxrss) * 1024;
+    }
+}
+
+NJson::TJsonValue TMemoryReport::ToJson() const {
+    NJson::TJsonValue result(NJson::JSON_MAP);
+    result["process"] = ProcessStats;
+
+    auto& queries = result["queries"];
+    queries.SetType(NJson::JSON_ARRAY);
+    for (size_t i = 0; i < Queries.size(); ++i) {
+        const auto& query = Queries[i];
+        auto& queryJson = queries.AppendValue(NJson::TJsonValue(NJson::JSON_MAP));
+        queryJson["name"] = QueryNames[i];
+        queryJson["executions"] = query.Executions;
+        queryJson["peak_memory_bytes"] = query.PeakMemory;
+        queryJson["max_task_memory_bytes"] = query.MaxTaskMemory;
+        queryJson["spilling_bytes"] = query.SpillingBytes;
+
+        auto& stages = queryJson["stages"];
+        stages.SetType(NJson::JSON_ARRAY);
+        for (const auto& [_, stage] : query.Stages) {
+            auto& stageJson = stages.AppendValue(NJson::TJsonValue(NJson::JSON_MAP));
+            stageJson["name"] = stage.Name;
+            stageJson["max_task_memory_bytes"] = stage.MaxTaskMemory;
+            stageJson["total_memory_bytes"] = stage.TotalMemory;
+        }
+    }
+    return result;
+}
+
+void TMemoryReport::PrintSummary(IOutputStream& output) const {
+    NColorizer::TColors colors = NColorizer::AutoColors(output);
+
+    output << colors.Cyan() << "Memory statistics (MB):" << colors.Default() << Endl;
+    for (size_t i = 0; i < Queries.size(); ++i) {
+        const auto& query = Queries[i];
+        output << "  " << QueryNames[i];
+        if (!query.Executions) {
+            output << ": no plan statistics" << Endl;
+            continue;
+        }
+        output << ": peak " << FormatMb(query.PeakMemory)
+            << ", max task " << FormatMb(query.MaxTaskMemory)
+            << ", spilled " << FormatMb(query.SpillingBytes) << Endl;
+    }
+
+    output << "  process:";
+    TStringBuf separator = " ";
+    if (ProcessStats.Has("max_rss_bytes")) {
+        output << separator << "max rss " << FormatMb(ProcessStats["max_rss_bytes"].GetUInteger());
+        separator = ", ";
+    }
+    for (const auto& [property, value] : ProcessStats["tcmalloc"].GetMap()) {
+        output << separator << property << " " << FormatMb(value.GetUInteger());
+        separator = ", ";
+    }
+    output << Endl;
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "plan_stats.h"
+
+#include <library/cpp/json/json_value.h>
+
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+
+#include <map>
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Peak memory of -p queries from plan statistics (maximum over loop iterations)
+// and process wide allocator statistics at the end of run
+class TMemoryReport {
+public:
+    void StartRun(const std::vector<TString>& queryNames);
+    void AddQuery(size_t index, const std::vector<TStageStats>& stages);
+    void FinishRun();
+
+    NJson::TJsonValue ToJson() const;
+    void PrintSummary(IOutputStream& output) const;
+
+private:
+    struct TStageMemory {
+        TString Name;
+        ui64 MaxTaskMemory = 0;
+        ui64 TotalMemory = 0;
+    };
+
+    struct TQueryMemory {
+        ui64 Executions = 0;
+        // Sum of stage memory, upper bound of query memory usage
+        ui64 PeakMemory = 0;
+        ui64 MaxTaskMemory = 0;
+        ui64 SpillingBytes = 0;
+        std::map<ui64, TStageMemory> Stages;
+    };
+
+private:
+    std::vector<TString> QueryNames;
+    std::vector<TQueryMemory> Queries;
+    NJson::TJsonValue ProcessStats;
+};
+
+}  // namespace NKqpRun
@@ -0,0 +1,191 @@
+#include "metrics.h"
+
+#include <library/cpp/http/misc/httpcodes.h>
+#include <library/cpp/http/misc/parsed_request.h>
+#include <library/cpp/http/server/http.h>
+#include <library/cpp/http/server/response.h>
+
+#include <util/string/builder.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+void PrintHeader(IOutputStream& output, TStringBuf name, TStringBuf type, TStringBuf help) {
+    output << "# HELP " << name << ' ' << help << '\n';
+    output << "# TYPE " << name << ' ' << type << '\n';
+}
+
+TString QueryLabel(const TString& query) {
+    TStringBuilder label;
+    label << "query=\"";
+    for (const char c : query) {
+        if (c == '"' || c == '\\') {
+            label << '\\' << c;
+        } else if (c == '\n') {
+            label << "\\n";
+        } else {
+            label << c;
+        }
+    }
+    label << '"';
+    return label;
+}
+
+}  // anonymous namespace
+
+void TClientMetrics::QueryStarted(const TString& query) {
+    TGuard<TMutex> guard(Mutex);
+    Queries[query].InFlight++;
+}
+
+void TClientMetrics::QueryFinished(const TString& query, TDuration latency, bool success) {
+    TGuard<TMutex> guard(Mutex);
+    auto& metrics = Queries[query];
+    Y_ABORT_UNLESS(metrics.InFlight);
+    metrics.InFlight--;
+    if (!success) {
+        metrics.Failed++;
+        return;
+    }
+
+    metrics.Completed++;
+    metrics.LatencySum += latency;
+    for (size_t i = 0; i < LATENCY_BUCKETS_US.size(); ++i) {
+        if (latency.MicroSeconds() <= LATENCY_BUCKETS_US[i]) {
+            metrics.LatencyBuckets[i]++;
+            break;
+        }
+    }
+}
+
+void TClientMetrics::QuerySubmitted(const TString& query) {
+    TGuard<TMutex> guard(Mutex);
+    Queries[query].Submitted++;
+}
+
+void TClientMetrics::AddResult(const TString& query, std::optional<ui64> rows, ui64 bytes) {
+    TGuard<TMutex> guard(Mutex);
+    auto& metrics = Queries[query];
+    if (rows) {
+        metrics.ResultRows = metrics.ResultRows.value_or(0) + *rows;
+    }
+    metrics.ResultBytes += bytes;
+}
+
+void TClientMetrics::AddCompilation(const TString& query, bool fromCache) {
+    TGuard<TMutex> guard(Mutex);
+    auto& metrics = Queries[query];
+    if (fromCache) {
+        metrics.CompileCacheHits++;
+    } else {
+        metrics.CompileCacheMisses++;
+    }
+}
+
+void TClientMetrics::Print(IOutputStream& output) const {
+    std::map<TString, TQueryMetrics> queries;
+    with_lock (Mutex) {
+        queries = Queries;
+    }
+
+    const auto printCounter = [&](TStringBuf name, TStringBuf type, TStringBuf help, ui64 TQueryMetrics::* field) {
+        PrintHeader(output, name, type, help);
+        for (const auto& [query, metrics] : queries) {
+            output << name << '{' << QueryLabel(query) << "} " << metrics.*field << '\n';
+        }
+    };
+    printCounter("kqprun_queries_in_flight", "gauge", "Number of running synchronous queries", &TQueryMetrics::InFlight);
+    printCounter("kqprun_queries_submitted_total", "counter", "Number of submitted async queries", &TQueryMetrics::Submitted);
+    printCounter("kqprun_queries_completed_total", "counter", "Number of successfully finished queries", &TQueryMetrics::Completed);
+    printCounter("kqprun_queries_failed_total", "counter", "Number of failed queries", &TQueryMetrics::Failed);
+    printCounter("kqprun_result_bytes_total", "counter", "Number of fetched script result bytes, measured as printed in --result-format", &TQueryMetrics::ResultBytes);
+
+    // Exported only for queries with known values, zero would be indistinguishable from not measured
+    PrintHeader(output, "kqprun_result_rows_total", "counter", "Number of fetched script result rows, counted only for rows result format");
+    for (const auto& [query, metrics] : queries) {
+        if (metrics.ResultRows) {
+            output << "kqprun_result_rows_total{" << QueryLabel(query) << "} " << *metrics.ResultRows << '\n';
+        }
+    }
+    const auto printCompilationCounter = [&](TStringBuf name, TStringBuf help, ui64 TQueryMetrics::* field) {
+        PrintHeader(output, name, "counter", help);
+        for (const auto& [query, metrics] : queries) {
+            if (metrics.CompileCacheHits || metrics.CompileCacheMisses) {
+                output << name << '{' << QueryLabel(query) << "} " << metrics.*field << '\n';
+            }
+        }
+    };
+    printCompilationCounter("kqprun_compile_cache_hits_total", "Number of queries compiled from compile cache, taken from query plans", &TQueryMetrics::CompileCacheHits);
+    printCompilationCounter("kqprun_compile_cache_misses_total", "Number of queries compiled without compile cache, taken from query plans", &TQueryMetrics::CompileCacheMisses);
+
+    const TStringBuf latencyName = "kqprun_query_latency_seconds";
+    PrintHeader(output, latencyName, "histogram", "Latency of successfully finished synchronous queries");
+    for (const auto& [query, metrics] : queries) {
+        const TString label = QueryLabel(query);
+        ui64 cumulative = 0;
+        for (size_t i = 0; i < LATENCY_BUCKETS_US.size(); ++i) {
+            cumulative += metrics.LatencyBuckets[i];
+            output << latencyName << "_bucket{" << label << ",le=\"" << LATENCY_BUCKETS_US[i] / 1'000'000.0 << "\"} " << cumulative << '\n';
+        }
+        output << latencyName << "_bucket{" << label << ",le=\"+Inf\"} " << metrics.Completed << '\n';
+        output << latencyName << "_sum{" << label << "} " << metrics.LatencySum.SecondsFloat() << '\n';
+        output << latencyName << "_count{" << label << "} " << metrics.Completed << '\n';
+    }
+}
+
+class TMetricsServer::TImpl : public THttpServer::ICallBack {
+    class TReplier : public TRequestReplier {
+    public:
+        explicit TReplier(const TClientMetrics& metrics)
+            : Metrics(metrics)
+        {}
+
+        bool DoReply(const TReplyParams& params) override {
+            const TParsedHttpFull request(params.Input.FirstLine());
+
+            if (request.Path == "/metrics" && request.Method == "GET") {
+                TStringStream content;
+                Metrics.Print(content);
+                params.Output << THttpResponse(HTTP_OK).SetContent(content.Str(), "text/plain; version=0.0.4");
+            } else {
+                params.Output << THttpResponse(HTTP_NOT_FOUND).SetContent(TStringBuilder() << "unknown handler " << request.Method << " " << request.Path, "text/plain");
+            }
+            return true;
+        }
+
+    private:
+        const TClientMetrics& Metrics;
+    };
+
+public:
+    TImpl(ui16 port, std::shared_ptr<TClientMetrics> metrics)
+        : Metrics(std::move(metrics))
+        , HttpServer(this, THttpServer::TOptions(port).SetThreads(1))
+    {
+        if (!HttpServer.Start()) {
+            ythrow yexception() << "Failed to start metrics server on port " << port << ", reason: " << HttpServer.GetError();
+        }
+    }
+
+    ~TImpl() {
+        HttpServer.Stop();
+    }
+
+    TClientRequest* CreateClient() override {
+        return new TReplier(*Metrics);
+    }
+
+private:
+    const std::shared_ptr<TClientMetrics> Metrics;
+    THttpServer HttpServer;
+};
+
+TMetricsServer::TMetricsServer(ui16 port, std::shared_ptr<TClientMetrics> metrics)
+    : Impl(MakeHolder<TImpl>(port, std::move(metrics)))
+{}
+
+TMetricsServer::~TMetricsServer() = default;
+
+}  // namespace NKqpRun
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <util/datetime/base.h>
+#include <util/generic/ptr.h>
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+#include <util/system/mutex.h>
+
+#include <array>
+#include <map>
+#include <memory>
+#include <optional>
+
+
+namespace NKqpRun {
+
+// Client side counters of kqprun, updated from execution loop and read by metrics server threads
+class TClientMetrics {
+public:
+    void QueryStarted(const TString& query);
+    void QueryFinished(const TString& query, TDuration latency, bool success);
+    // Async queries are not tracked in flight, their completion is not visible
+    void QuerySubmitted(const TString& query);
+    // Rows are known only for rows result format
+    void AddResult(const TString& query, std::optional<ui64> rows, ui64 bytes);
+    // Compilation statistics are known only if query plans are captured
+    void AddCompilation(const TString& query, bool fromCache);
+
+    // Prometheus text exposition format
+    void Print(IOutputStream& output) const;
+
+private:
+    // Latency buckets upper bounds in microseconds
+    static constexpr std::array<ui64, 14> LATENCY_BUCKETS_US = {
+        500, 1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000, 250'000, 500'000, 1'000'000, 2'500'000, 5'000'000, 10'000'000
+    };
+
+    struct TQueryMetrics {
+        ui64 InFlight = 0;
+        ui64 Submitted = 0;
+        ui64 Completed = 0;
+        ui64 Failed = 0;
+        std::array<ui64, LATENCY_BUCKETS_US.size()> LatencyBuckets = {};
+        TDuration LatencySum;
+        std::optional<ui64> ResultRows;
+        ui64 ResultBytes = 0;
+        ui64 CompileCacheHits = 0;
+        ui64 CompileCacheMisses = 0;
+    };
+
+private:
+    mutable TMutex Mutex;
+    std::map<TString, TQueryMetrics> Queries;
+};
+
+// HTTP server with single handler:
+//   GET /metrics  -- client metrics in prometheus format
+class TMetricsServer {
+public:
+    TMetricsServer(ui16 port, std::shared_ptr<TClientMetrics> metrics);
+    ~TMetricsServer();
+
+private:
+    class TImpl;
+    THolder<TImpl> Impl;
+};
+
+}  // namespace NKqpRun
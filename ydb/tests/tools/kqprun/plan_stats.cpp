@@ -0,0 +1,347 @@
+#include "plan_stats.h"
+
+#include <library/cpp/json/json_reader.h>
+
+#include <util/digest/murmur.h>
+#include <util/string/builder.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+// Stage statistics are either plain numbers or aggregates over tasks: {"Min", "Max", "Sum", "Count"}
+ui64 GetAggregate(const NJson::TJsonValue& stats, const TString& key, const TString& aggregate) {
+    const NJson::TJsonValue* value = nullptr;
+    if (!stats.GetValuePointer(key, &value)) {
+        return 0;
+    }
+    if (value->IsMap()) {
+        const NJson::TJsonValue* aggregateValue = nullptr;
+        return value->GetValuePointer(aggregate, &aggregateValue) ? aggregateValue->GetUIntegerRobust() : 0;
+    }
+    return value->GetUIntegerRobust();
+}
+
+ui64 GetSum(const NJson::TJsonValue& stats, const TString& key) {
+    return GetAggregate(stats, key, "Sum");
+}
+
+ui64 GetMax(const NJson::TJsonValue& stats, const TString& key) {
+    return GetAggregate(stats, key, "Max");
+}
+
+ui64 GetChannelBytes(const NJson::TJsonValue& stats, const TString& key) {
+    ui64 bytes = 0;
+    const NJson::TJsonValue* channels = nullptr;
+    if (!stats.GetValuePointer(key, &channels) || !channels->IsArray()) {
+        return bytes;
+    }
+    for (const auto& channel : channels->GetArray()) {
+        const NJson::TJsonValue* push = nullptr;
+        if (channel.GetValuePointer("Push", &push)) {
+            bytes += GetSum(*push, "Bytes");
+        }
+    }
+    return bytes;
+}
+
+ui64 GetTableStats(const NJson::TJsonValue& stats, const TString& key) {
+    ui64 result = 0;
+    const NJson::TJsonValue* tables = nullptr;
+    if (!stats.GetValuePointer("Table", &tables) || !tables->IsArray()) {
+        return result;
+    }
+    for (const auto& table : tables->GetArray()) {
+        result += GetSum(table, key);
+    }
+    return result;
+}
+
+std::map<ui64, TNodeTasks> GetNodeTasks(const NJson::TJsonValue& stats) {
+    std::map<ui64, TNodeTasks> result;
+    const NJson::TJsonValue* computeNodes = nullptr;
+    if (!stats.GetValuePointer("ComputeNodes", &computeNodes) || !computeNodes->IsArray()) {
+        return result;
+    }
+    for (const auto& computeNode : computeNodes->GetArray()) {
+        const NJson::TJsonValue* tasks = nullptr;
+        if (!computeNode.GetValuePointer("Tasks", &tasks) || !tasks->IsArray()) {
+            continue;
+        }
+        for (const auto& task : tasks->GetArray()) {
+            auto& node = result[task["NodeId"].GetUIntegerRobust()];
+            node.Tasks++;
+            node.OutputChannelBytes += GetChannelBytes(task, "Output");
+        }
+    }
+    return result;
+}
+
+void CollectStages(const NJson::TJsonValue& node, std::vector<TStageStats>& stages) {
+    if (!node.IsMap()) {
+        return;
+    }
+
+    // Query level statistics of plan root are not stage statistics
+    const NJson::TJsonValue* stats = nullptr;
+    if (node.GetValuePointer("Stats", &stats) && stats->IsMap() && !stats->Has("Compilation")) {
+        const ui64 planNodeId = node["PlanNodeId"].GetUIntegerRobust();
+        stages.push_back({
+            .Name = TStringBuilder() << node["Node Type"].GetStringRobust() << " #" << planNodeId,
+            .PlanNodeId = planNodeId,
+            .Tasks = GetSum(*stats, "Tasks"),
+            .Duration = TDuration::MicroSeconds(GetMax(*stats, "DurationUs")),
+            .MaxMemoryUsage = GetMax(*stats, "MaxMemoryUsage"),
+            .CpuTime = TDuration::MicroSeconds(GetSum(*stats, "CpuTimeUs")),
+            .WaitInputTime = TDuration::MicroSeconds(GetSum(*stats, "WaitInputTimeUs")),
+            .WaitOutputTime = TDuration::MicroSeconds(GetSum(*stats, "WaitOutputTimeUs")),
+            .TotalMemoryUsage = GetSum(*stats, "MaxMemoryUsage"),
+            .OutputRows = GetSum(*stats, "OutputRows"),
+            .OutputBytes = GetSum(*stats, "OutputBytes"),
+            .TableReadRows = GetTableStats(*stats, "ReadRows"),
+            .TableReadBytes = GetTableStats(*stats, "ReadBytes"),
+            .InputChannelBytes = GetChannelBytes(*stats, "Input"),
+            .OutputChannelBytes = GetChannelBytes(*stats, "Output"),
+            .SpillingComputeBytes = GetSum(*stats, "SpillingComputeBytes"),
+            .SpillingChannelBytes = GetSum(*stats, "SpillingChannelBytes"),
+            .SpillingComputeTime = TDuration::MicroSeconds(GetSum(*stats, "SpillingComputeTimeUs")),
+            .SpillingChannelTime = TDuration::MicroSeconds(GetSum(*stats, "SpillingChannelTimeUs")),
+            .Nodes = GetNodeTasks(*stats)
+        });
+
+        auto& stage = stages.back();
+        stage.SpillingBytes = stage.SpillingComputeBytes + stage.SpillingChannelBytes;
+        stage.SpillingTime = stage.SpillingComputeTime + stage.SpillingChannelTime;
+    }
+
+    const NJson::TJsonValue* plans = nullptr;
+    if (node.GetValuePointer("Plans", &plans) && plans->IsArray()) {
+        for (const auto& child : plans->GetArray()) {
+            CollectStages(child, stages);
+        }
+    }
+}
+
+const NJson::TJsonValue* FindQueryStats(const NJson::TJsonValue& node) {
+    if (!node.IsMap()) {
+        return nullptr;
+    }
+
+    const NJson::TJsonValue* stats = nullptr;
+    if (node.GetValuePointer("Stats", &stats) && stats->IsMap() && stats->Has("Compilation")) {
+        return stats;
+    }
+
+    const NJson::TJsonValue* plans = nullptr;
+    if (node.GetValuePointer("Plans", &plans) && plans->IsArray()) {
+        for (const auto& child : plans->GetArray()) {
+            if (const auto* result = FindQueryStats(child)) {
+                return result;
+            }
+        }
+    }
+    return nullptr;
+}
+
+// Returns size of the first json object in text, or zero if it is not printed completely
+size_t GetJsonObjectSize(TStringBuf text) {
+    size_t depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if ((c == '}' || c == ']') && depth && --depth == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void PrintPlanShape(const NJson::TJsonValue& node, IOutputStream& output) {
+    if (!node.IsMap()) {
+        return;
+    }
+
+    output << '(' << node["Node Type"].GetStringRobust();
+    const NJson::TJsonValue* operators = nullptr;
+    if (node.GetValuePointer("Operators", &operators) && operators->IsArray()) {
+        for (const auto& op : operators->GetArray()) {
+            output << ' ' << op["Name"].GetStringRobust();
+            if (op.Has("Table")) {
+                output << ':' << op["Table"].GetStringRobust();
+            }
+        }
+    }
+
+    const NJson::TJsonValue* plans = nullptr;
+    if (node.GetValuePointer("Plans", &plans) && plans->IsArray()) {
+        for (const auto& child : plans->GetArray()) {
+            PrintPlanShape(child, output);
+        }
+    }
+    output << ')';
+}
+
+}  // anonymous namespace
+
+//// TPlanCapture
+
+TPlanCapture::TPlanCapture(IOutputStream* forward)
+    : Forward(forward)
+{}
+
+NJson::TJsonValue TPlanCapture::ExtractPlan() {
+    TGuard<TMutex> lock(Mutex);
+    NJson::TJsonValue plan;
+    if (const TString& text = Buffer.Str()) {
+        if (!NJson::ReadJsonTree(text, &plan)) {
+            plan = NJson::TJsonValue();
+        }
+    }
+    Buffer.Clear();
+    return plan;
+}
+
+std::vector<NJson::TJsonValue> TPlanCapture::ExtractPlans() {
+    TGuard<TMutex> lock(Mutex);
+    std::vector<NJson::TJsonValue> plans;
+    TStringBuf text = Buffer.Str();
+    while (true) {
+        const size_t begin = text.find('{');
+        if (begin == TStringBuf::npos) {
+            text.Clear();
+            break;
+        }
+        text.Skip(begin);
+        const size_t size = GetJsonObjectSize(text);
+        if (!size) {
+            break;
+        }
+        NJson::TJsonValue plan;
+        if (NJson::ReadJsonTree(text.Head(size), &plan)) {
+            plans.emplace_back(std::move(plan));
+        }
+        text.Skip(size);
+    }
+
+    TString tail(text);
+    Buffer.Clear();
+    Buffer << tail;
+    return plans;
+}
+
+void TPlanCapture::DoWrite(const void* buf, size_t len) {
+    TGuard<TMutex> lock(Mutex);
+    Buffer.Write(buf, len);
+    if (Forward) {
+        Forward->Write(buf, len);
+    }
+}
+
+void TPlanCapture::DoFlush() {
+    TGuard<TMutex> lock(Mutex);
+    if (Forward) {
+        Forward->Flush();
+    }
+}
+
+//// Stage statistics
+
+std::vector<TStageStats> ParseStageStats(const NJson::TJsonValue& plan) {
+    std::vector<TStageStats> stages;
+    const NJson::TJsonValue* root = nullptr;
+    CollectStages(plan.GetValuePointer("Plan", &root) ? *root : plan, stages);
+    return stages;
+}
+
+//// Compilation statistics
+
+std::optional<TCompilationStats> ParseCompilationStats(const NJson::TJsonValue& plan) {
+    const NJson::TJsonValue* root = nullptr;
+    const auto* stats = FindQueryStats(plan.GetValuePointer("Plan", &root) ? *root : plan);
+    if (!stats) {
+        return std::nullopt;
+    }
+
+    const auto& compilation = (*stats)["Compilation"];
+    TCompilationStats result = {
+        .FromCache = compilation["FromCache"].GetBooleanRobust(),
+        .Duration = TDuration::MicroSeconds(compilation["DurationUs"].GetUIntegerRobust()),
+        .CpuTime = TDuration::MicroSeconds(compilation["CpuTimeUs"].GetUIntegerRobust()),
+        .TotalDuration = TDuration::MicroSeconds((*stats)["TotalDurationUs"].GetUIntegerRobust())
+    };
+    if (const NJson::TJsonValue* queuedTime = nullptr; stats->GetValuePointer("QueuedTimeUs", &queuedTime)) {
+        result.QueuedTime = TDuration::MicroSeconds(queuedTime->GetUIntegerRobust());
+    }
+    return result;
+}
+
+//// TPlanTotals
+
+void TPlanTotals::Add(const std::vector<TStageStats>& stages) {
+    if (stages.empty()) {
+        return;
+    }
+    Executions++;
+    for (const auto& stage : stages) {
+        CpuTime += stage.CpuTime;
+        TableReadRows += stage.TableReadRows;
+        TableReadBytes += stage.TableReadBytes;
+        for (const auto& [nodeId, tasks] : stage.Nodes) {
+            auto& node = Nodes[nodeId];
+            node.Tasks += tasks.Tasks;
+            node.OutputChannelBytes += tasks.OutputChannelBytes;
+        }
+    }
+    // Final stage is the first one in plan
+    OutputRows += stages.front().OutputRows;
+}
+
+ui64 TPlanTotals::GetExecutions() const {
+    return Executions;
+}
+
+NJson::TJsonValue TPlanTotals::ToJson() const {
+    NJson::TJsonValue result(NJson::JSON_MAP);
+    result["executions"] = Executions;
+    if (!Executions) {
+        return result;
+    }
+    result["cpu_us"] = CpuTime.MicroSeconds() / Executions;
+    result["table_read_rows"] = TableReadRows / Executions;
+    result["table_read_bytes"] = TableReadBytes / Executions;
+    result["output_rows"] = OutputRows / Executions;
+    if (!Nodes.empty()) {
+        auto& nodes = result["nodes"];
+        nodes.SetType(NJson::JSON_ARRAY);
+        for (const auto& [nodeId, node] : Nodes) {
+            auto& nodeJson = nodes.AppendValue(NJson::TJsonValue(NJson::JSON_MAP));
+            nodeJson["node_id"] = nodeId;
+            nodeJson["tasks"] = static_cast<double>(node.Tasks) / Executions;
+            nodeJson["output_channel_bytes"] = node.OutputChannelBytes / Executions;
+        }
+    }
+    return result;
+}
+
+ui64 GetPlanHash(const NJson::TJsonValue& plan) {
+    TStringStream shape;
+    const NJson::TJsonValue* root = nullptr;
+    PrintPlanShape(plan.GetValuePointer("Plan", &root) ? *root : plan, shape);
+    return MurmurHash<ui64>(shape.Str().data(), shape.Str().size());
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <library/cpp/json/json_value.h>
+
+#include <util/datetime/base.h>
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+#include <util/stream/str.h>
+#include <util/system/mutex.h>
+
+#include <map>
+#include <optional>
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Used as script plan output of runner, keeps plans printed since last extraction
+// and forwards them to user plan output if it is specified. Plans of async queries
+// are printed from runner threads on completion, so output is synchronized
+class TPlanCapture : public IOutputStream {
+public:
+    explicit TPlanCapture(IOutputStream* forward);
+
+    // Returns undefined json value if runner did not print plan or plan is not in json format
+    NJson::TJsonValue ExtractPlan();
+
+    // Returns all completely printed json plans, incomplete tail is kept until the next extraction
+    std::vector<NJson::TJsonValue> ExtractPlans();
+
+protected:
+    void DoWrite(const void* buf, size_t len) override;
+    void DoFlush() override;
+
+private:
+    IOutputStream* Forward;
+    TMutex Mutex;
+    TStringStream Buffer;
+};
+
+// Tasks of stage placed on one node
+struct TNodeTasks {
+    ui64 Tasks = 0;
+    ui64 OutputChannelBytes = 0;
+};
+
+// Execution statistics of one plan stage, aggregated over stage tasks
+struct TStageStats {
+    TString Name;
+    ui64 PlanNodeId = 0;
+    ui64 Tasks = 0;
+    // Max over tasks
+    TDuration Duration;
+    ui64 MaxMemoryUsage = 0;
+    // Sum over tasks
+    TDuration CpuTime;
+    TDuration WaitInputTime;
+    TDuration WaitOutputTime;
+    ui64 TotalMemoryUsage = 0;
+    ui64 OutputRows = 0;
+    ui64 OutputBytes = 0;
+    ui64 TableReadRows = 0;
+    ui64 TableReadBytes = 0;
+    ui64 InputChannelBytes = 0;
+    ui64 OutputChannelBytes = 0;
+    ui64 SpillingComputeBytes = 0;
+    ui64 SpillingChannelBytes = 0;
+    TDuration SpillingComputeTime;
+    TDuration SpillingChannelTime;
+    // Compute and channels spilling together
+    ui64 SpillingBytes = 0;
+    TDuration SpillingTime;
+    // Per node distribution of tasks, present only for profile statistics with compute nodes info
+    std::map<ui64, TNodeTasks> Nodes;
+};
+
+std::vector<TStageStats> ParseStageStats(const NJson::TJsonValue& plan);
+
+// Query level statistics from plan root, KQP does not report parse time separately,
+// so it is included into compilation
+struct TCompilationStats {
+    bool FromCache = false;
+    TDuration Duration;
+    TDuration CpuTime;
+    // Whole query duration on server side, zero if not reported
+    TDuration TotalDuration;
+    // Admission wait in workload manager pool, if reported
+    std::optional<TDuration> QueuedTime;
+};
+
+// Returns nullopt if plan does not contain compilation statistics
+std::optional<TCompilationStats> ParseCompilationStats(const NJson::TJsonValue& plan);
+
+// Query totals over all stages, averaged over loop iterations
+class TPlanTotals {
+public:
+    void Add(const std::vector<TStageStats>& stages);
+
+    ui64 GetExecutions() const;
+    NJson::TJsonValue ToJson() const;
+
+private:
+    ui64 Executions = 0;
+    // Summed over all stages
+    std::map<ui64, TNodeTasks> Nodes;
+    TDuration CpuTime;
+    ui64 TableReadRows = 0;
+    ui64 TableReadBytes = 0;
+    ui64 OutputRows = 0;
+};
+
+// Hash of plan shape: node types, operators and tables, statistics and estimations are ignored
+ui64 GetPlanHash(const NJson::TJsonValue& plan);
+
+}  // namespace NKqpRun
@@ -0,0 +1,205 @@
+#include "plan_stats.h"
+
+#include <library/cpp/json/json_reader.h>
+#include <library/cpp/testing/unittest/registar.h>
+
+#include <util/string/subst.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+// Reduced profile plan of "SELECT * FROM test_table LIMIT 10", stage with table scan runs two tasks on two nodes
+const TString PLAN = R"({
+    "Plan": {
+        "Node Type": "Query",
+        "PlanNodeType": "Query",
+        "Stats": {
+            "Compilation": {"FromCache": false, "DurationUs": 1500, "CpuTimeUs": 1200},
+            "TotalDurationUs": 5000,
+            "QueuedTimeUs": 300
+        },
+        "Plans": [{
+            "Node Type": "ResultSet",
+            "PlanNodeId": 3,
+            "Operators": [{"Name": "Limit", "Limit": "10", "E-Rows": "10", "A-Rows": 10}],
+            "Stats": {
+                "Tasks": 1,
+                "DurationUs": {"Max": 800, "Sum": 800},
+                "CpuTimeUs": {"Max": 400, "Sum": 400},
+                "OutputRows": {"Sum": 10},
+                "OutputBytes": {"Sum": 100},
+                "Input": [{"Push": {"Bytes": {"Sum": 1000}}}]
+            },
+            "Plans": [{
+                "Node Type": "TableFullScan",
+                "PlanNodeId": 1,
+                "Operators": [{"Name": "TableFullScan", "Table": "test_table", "E-Rows": "1000"}],
+                "Stats": {
+                    "Tasks": {"Sum": 2, "Count": 2},
+                    "DurationUs": {"Max": 700, "Sum": 1300},
+                    "CpuTimeUs": {"Max": 500, "Sum": 900},
+                    "MaxMemoryUsage": {"Max": 3000, "Sum": 5000},
+                    "OutputRows": {"Sum": 100},
+                    "OutputBytes": {"Sum": 1000},
+                    "SpillingComputeBytes": {"Sum": 64},
+                    "SpillingChannelBytes": {"Sum": 32},
+                    "Table": [{"Path": "/Root/test_table", "ReadRows": {"Sum": 100}, "ReadBytes": {"Sum": 2000}}],
+                    "Output": [{"Name": "3", "Push": {"Bytes": {"Sum": 1000}}}],
+                    "ComputeNodes": [{
+                        "Tasks": [
+                            {"NodeId": 1, "Output": [{"Push": {"Bytes": {"Sum": 600}}}]},
+                            {"NodeId": 2, "Output": [{"Push": {"Bytes": {"Sum": 400}}}]}
+                        ]
+                    }]
+                }
+            }]
+        }]
+    }
+})";
+
+NJson::TJsonValue ParsePlan(const TString& text) {
+    NJson::TJsonValue plan;
+    UNIT_ASSERT(NJson::ReadJsonTree(text, &plan));
+    return plan;
+}
+
+}  // anonymous namespace
+
+Y_UNIT_TEST_SUITE(PlanStats) {
+    Y_UNIT_TEST(StageStats) {
+        const auto stages = ParseStageStats(ParsePlan(PLAN));
+        UNIT_ASSERT_VALUES_EQUAL(stages.size(), 2);
+
+        const auto& result = stages[0];
+        UNIT_ASSERT_VALUES_EQUAL(result.Name, "ResultSet #3");
+        UNIT_ASSERT_VALUES_EQUAL(result.Tasks, 1);
+        UNIT_ASSERT_VALUES_EQUAL(result.Duration, TDuration::MicroSeconds(800));
+        UNIT_ASSERT_VALUES_EQUAL(result.OutputRows, 10);
+        UNIT_ASSERT_VALUES_EQUAL(result.InputChannelBytes, 1000);
+        UNIT_ASSERT(result.Nodes.empty());
+
+        const auto& scan = stages[1];
+        UNIT_ASSERT_VALUES_EQUAL(scan.Name, "TableFullScan #1");
+        UNIT_ASSERT_VALUES_EQUAL(scan.PlanNodeId, 1);
+        UNIT_ASSERT_VALUES_EQUAL(scan.Tasks, 2);
+        UNIT_ASSERT_VALUES_EQUAL(scan.Duration, TDuration::MicroSeconds(700));
+        UNIT_ASSERT_VALUES_EQUAL(scan.CpuTime, TDuration::MicroSeconds(900));
+        UNIT_ASSERT_VALUES_EQUAL(scan.MaxMemoryUsage, 3000);
+        UNIT_ASSERT_VALUES_EQUAL(scan.TotalMemoryUsage, 5000);
+        UNIT_ASSERT_VALUES_EQUAL(scan.TableReadRows, 100);
+        UNIT_ASSERT_VALUES_EQUAL(scan.TableReadBytes, 2000);
+        UNIT_ASSERT_VALUES_EQUAL(scan.OutputChannelBytes, 1000);
+        UNIT_ASSERT_VALUES_EQUAL(scan.SpillingComputeBytes, 64);
+        UNIT_ASSERT_VALUES_EQUAL(scan.SpillingChannelBytes, 32);
+        UNIT_ASSERT_VALUES_EQUAL(scan.SpillingBytes, 96);
+
+        UNIT_ASSERT_VALUES_EQUAL(scan.Nodes.size(), 2);
+        UNIT_ASSERT_VALUES_EQUAL(scan.Nodes.at(1).Tasks, 1);
+        UNIT_ASSERT_VALUES_EQUAL(scan.Nodes.at(1).OutputChannelBytes, 600);
+        UNIT_ASSERT_VALUES_EQUAL(scan.Nodes.at(2).OutputChannelBytes, 400);
+    }
+
+    Y_UNIT_TEST(NoStats) {
+        UNIT_ASSERT(ParseStageStats(NJson::TJsonValue()).empty());
+        UNIT_ASSERT(ParseStageStats(ParsePlan(R"({"Plan": {"Node Type": "Query", "Plans": [{"Node Type": "ResultSet"}]}})")).empty());
+        UNIT_ASSERT(!ParseCompilationStats(NJson::TJsonValue()));
+    }
+
+    Y_UNIT_TEST(CompilationStats) {
+        const auto compilation = ParseCompilationStats(ParsePlan(PLAN));
+        UNIT_ASSERT(compilation);
+        UNIT_ASSERT(!compilation->FromCache);
+        UNIT_ASSERT_VALUES_EQUAL(compilation->Duration, TDuration::MicroSeconds(1500));
+        UNIT_ASSERT_VALUES_EQUAL(compilation->CpuTime, TDuration::MicroSeconds(1200));
+        UNIT_ASSERT_VALUES_EQUAL(compilation->TotalDuration, TDuration::MicroSeconds(5000));
+        UNIT_ASSERT(compilation->QueuedTime);
+        UNIT_ASSERT_VALUES_EQUAL(*compilation->QueuedTime, TDuration::MicroSeconds(300));
+
+        TString plan = PLAN;
+        SubstGlobal(plan, "\"QueuedTimeUs\": 300", "\"QueuedTimeUs2\": 300");
+        UNIT_ASSERT(!ParseCompilationStats(ParsePlan(plan))->QueuedTime);
+    }
+
+    Y_UNIT_TEST(PlanHash) {
+        const ui64 hash = GetPlanHash(ParsePlan(PLAN));
+
+        // Statistics and estimations do not change plan shape
+        TString plan = PLAN;
+        SubstGlobal(plan, "\"E-Rows\": \"1000\"", "\"E-Rows\": \"5\"");
+        SubstGlobal(plan, "{\"Sum\": 100}", "{\"Sum\": 7}");
+        UNIT_ASSERT_VALUES_EQUAL(GetPlanHash(ParsePlan(plan)), hash);
+
+        SubstGlobal(plan, "\"Table\": \"test_table\"", "\"Table\": \"other_table\"");
+        UNIT_ASSERT_VALUES_UNEQUAL(GetPlanHash(ParsePlan(plan)), hash);
+
+        plan = PLAN;
+        SubstGlobal(plan, "\"Name\": \"TableFullScan\"", "\"Name\": \"TableRangeScan\"");
+        UNIT_ASSERT_VALUES_UNEQUAL(GetPlanHash(ParsePlan(plan)), hash);
+    }
+
+    Y_UNIT_TEST(Totals) {
+        const auto stages = ParseStageStats(ParsePlan(PLAN));
+
+        TPlanTotals totals;
+        totals.Add({});
+        UNIT_ASSERT_VALUES_EQUAL(totals.GetExecutions(), 0);
+
+        totals.Add(stages);
+        totals.Add(stages);
+        UNIT_ASSERT_VALUES_EQUAL(totals.GetExecutions(), 2);
+
+        const auto json = totals.ToJson();
+        UNIT_ASSERT_VALUES_EQUAL(json["executions"].GetUInteger(), 2);
+        UNIT_ASSERT_VALUES_EQUAL(json["cpu_us"].GetUInteger(), 1300);
+        UNIT_ASSERT_VALUES_EQUAL(json["table_read_rows"].GetUInteger(), 100);
+        UNIT_ASSERT_VALUES_EQUAL(json["table_read_bytes"].GetUInteger(), 2000);
+        UNIT_ASSERT_VALUES_EQUAL(json["output_rows"].GetUInteger(), 10);
+
+        const auto& nodes = json["nodes"].GetArray();
+        UNIT_ASSERT_VALUES_EQUAL(nodes.size(), 2);
+        UNIT_ASSERT_VALUES_EQUAL(nodes[0]["node_id"].GetUInteger(), 1);
+        UNIT_ASSERT_DOUBLES_EQUAL(nodes[0]["tasks"].GetDouble(), 1.0, 1e-9);
+        UNIT_ASSERT_VALUES_EQUAL(nodes[1]["output_channel_bytes"].GetUInteger(), 400);
+    }
+}
+
+Y_UNIT_TEST_SUITE(PlanCapture) {
+    Y_UNIT_TEST(ExtractPlan) {
+        TStringStream forward;
+        TPlanCapture capture(&forward);
+        capture << PLAN;
+
+        UNIT_ASSERT_VALUES_EQUAL(ParseStageStats(capture.ExtractPlan()).size(), 2);
+        UNIT_ASSERT_VALUES_EQUAL(forward.Str(), PLAN);
+        // Buffer is cleared on extraction
+        UNIT_ASSERT(!capture.ExtractPlan().IsDefined());
+
+        capture << "not a json";
+        UNIT_ASSERT(!capture.ExtractPlan().IsDefined());
+    }
+
+    Y_UNIT_TEST(ExtractPlans) {
+        TPlanCapture capture(nullptr);
+        capture << PLAN << Endl << R"({"Plan": {"Node Type": "Query, \"{quoted}\""}})" << Endl;
+
+        // Incomplete plan is kept until the rest of it is printed
+        const TString nextPlan = PLAN;
+        const size_t half = nextPlan.size() / 2;
+        capture << nextPlan.substr(0, half);
+
+        auto plans = capture.ExtractPlans();
+        UNIT_ASSERT_VALUES_EQUAL(plans.size(), 2);
+        UNIT_ASSERT(ParseCompilationStats(plans[0]));
+        UNIT_ASSERT_VALUES_EQUAL(plans[1]["Plan"]["Node Type"].GetString(), "Query, \"{quoted}\"");
+
+        capture << nextPlan.substr(half);
+        plans = capture.ExtractPlans();
+        UNIT_ASSERT_VALUES_EQUAL(plans.size(), 1);
+        UNIT_ASSERT_VALUES_EQUAL(ParseCompilationStats(plans[0])->TotalDuration, TDuration::MicroSeconds(5000));
+        UNIT_ASSERT(capture.ExtractPlans().empty());
+    }
+}
+
+}  // namespace NKqpRun
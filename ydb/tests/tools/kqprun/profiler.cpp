@@ -0,0 +1,399 @@
+#include "profiler.h"
+
+#include <contrib/libs/tcmalloc/tcmalloc/malloc_extension.h>
+
+#include <library/cpp/colorizer/colors.h>
+#include <library/cpp/dwarf_backtrace/backtrace.h>
+
+#include <util/generic/hash.h>
+#include <util/generic/yexception.h>
+#include <util/string/builder.h>
+#include <util/system/yield.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+constexpr size_t MAX_STACK_DEPTH = 48;
+constexpr size_t MAX_SAMPLES = 1 << 17;
+constexpr size_t THREAD_NAME_SIZE = 16;
+
+struct TCpuSample {
+    char ThreadName[THREAD_NAME_SIZE] = {};
+    size_t Depth = 0;
+    void* Stack[MAX_STACK_DEPTH] = {};
+};
+
+std::atomic<class TCpuSampler*> ActiveSampler = nullptr;
+// Number of signal handlers which may still use sampler loaded from ActiveSampler
+std::atomic<ui32> HandlersInFlight = 0;
+pid_t ProfiledProcess = 0;
+
+// Frame pointer of interrupted code may be garbage (frame pointers omitted, prologue
+// in progress), so frames are read by process_vm_readv, which fails with EFAULT
+// instead of raising SIGSEGV on unmapped address
+bool ReadFrame(uintptr_t fp, uintptr_t (&frame)[2]) {
+    iovec local = {.iov_base = frame, .iov_len = sizeof(frame)};
+    iovec remote = {.iov_base = reinterpret_cast<void*>(fp), .iov_len = sizeof(frame)};
+    return process_vm_readv(ProfiledProcess, &local, 1, &remote, 1, 0) == static_cast<ssize_t>(sizeof(frame));
+}
+
+// BackTrace is not async signal safe (unwinder may take locks and allocate), so
+// stack of interrupted thread is collected by frame pointers walk which uses only
+// system calls, walk stops on first frame which does not look like a valid one
+size_t CollectStack(const ucontext_t* context, void** stack, size_t maxDepth) {
+#if defined(__x86_64__)
+    const uintptr_t pc = context->uc_mcontext.gregs[REG_RIP];
+    const uintptr_t sp = context->uc_mcontext.gregs[REG_RSP];
+    uintptr_t fp = context->uc_mcontext.gregs[REG_RBP];
+#elif defined(__aarch64__)
+    const uintptr_t pc = context->uc_mcontext.pc;
+    const uintptr_t sp = context->uc_mcontext.sp;
+    uintptr_t fp = context->uc_mcontext.regs[29];
+#else
+    Y_UNUSED(context, stack, maxDepth);
+    return 0;
+#endif
+
+#if defined(__x86_64__) || defined(__aarch64__)
+    size_t depth = 0;
+    stack[depth++] = reinterpret_cast<void*>(pc);
+    while (depth < maxDepth) {
+        if (fp < sp || fp % sizeof(uintptr_t) != 0) {
+            break;
+        }
+
+        // Frame record: saved frame pointer of caller and return address
+        uintptr_t frame[2];
+        if (!ReadFrame(fp, frame)) {
+            break;
+        }
+        const uintptr_t nextFp = frame[0];
+        const uintptr_t returnAddress = frame[1];
+        if (!returnAddress) {
+            break;
+        }
+        stack[depth++] = reinterpret_cast<void*>(returnAddress);
+
+        // Stack grows down, so caller frame should be strictly above
+        if (nextFp <= fp) {
+            break;
+        }
+        fp = nextFp;
+    }
+    return depth;
+#endif
+}
+
+class TCpuSampler {
+public:
+    TCpuSampler()
+        : Samples(MAX_SAMPLES)
+    {}
+
+    void RecordSample(const ucontext_t* context) {
+        const size_t sampleId = NextSample.fetch_add(1, std::memory_order_relaxed);
+        if (sampleId >= Samples.size()) {
+            return;
+        }
+
+        auto& sample = Samples[sampleId];
+        if (prctl(PR_GET_NAME, sample.ThreadName, 0, 0, 0) != 0) {
+            strcpy(sample.ThreadName, "unknown");
+        }
+        sample.ThreadName[THREAD_NAME_SIZE - 1] = 0;
+        sample.Depth = CollectStack(context, sample.Stack, MAX_STACK_DEPTH);
+    }
+
+    // Should be called after profiling timer is stopped and signal handlers are finished
+    size_t GetNumberSamples() const {
+        return std::min(NextSample.load(std::memory_order_acquire), Samples.size());
+    }
+
+    size_t GetNumberDropped() const {
+        const size_t total = NextSample.load(std::memory_order_relaxed);
+        return total > Samples.size() ? total - Samples.size() : 0;
+    }
+
+    const TCpuSample& GetSample(size_t sampleId) const {
+        return Samples[sampleId];
+    }
+
+private:
+    std::vector<TCpuSample> Samples;
+    std::atomic<size_t> NextSample = 0;
+};
+
+// Handler stays installed for process lifetime, so SIGPROF which is still pending
+// after profiling timer is stopped does not terminate process
+void ProfilingSignalHandler(int, siginfo_t*, void* context) {
+    const int savedErrno = errno;
+    // Counter is increased before sampler is loaded, so profiler stop which reset
+    // ActiveSampler waits for this handler before freeing sampler
+    HandlersInFlight.fetch_add(1);
+    if (auto* sampler = ActiveSampler.load()) {
+        sampler->RecordSample(static_cast<const ucontext_t*>(context));
+    }
+    HandlersInFlight.fetch_sub(1);
+    errno = savedErrno;
+}
+
+void WaitSignalHandlers() {
+    while (HandlersInFlight.load()) {
+        SchedYield();
+    }
+}
+
+class TActiveSamplerGuard {
+public:
+    ~TActiveSamplerGuard() {
+        if (Active) {
+            ActiveSampler.store(nullptr);
+            WaitSignalHandlers();
+        }
+    }
+
+    void Release() {
+        Active = false;
+    }
+
+private:
+    bool Active = true;
+};
+
+class TSymbolizer {
+public:
+    void AddStack(void* const* stack, size_t depth) {
+        for (size_t i = 0; i < depth; ++i) {
+            Frames.emplace(stack[i], std::vector<TString>());
+        }
+    }
+
+    void Resolve() {
+        std::vector<const void*> addresses;
+        addresses.reserve(Frames.size());
+        for (const auto& [address, _] : Frames) {
+            addresses.emplace_back(address);
+        }
+
+        const auto error = NDwarf::ResolveBacktrace(addresses, [&](const NDwarf::TLineInfo& info) {
+            // Inlined functions are reported first, so names are in order from callee to caller
+            Frames[const_cast<void*>(addresses[info.Index])].emplace_back(info.FunctionName);
+            return NDwarf::EResolving::Continue;
+        });
+        if (error) {
+            Cerr << "Failed to resolve profile stacks, reason: " << error->Message << Endl;
+        }
+    }
+
+    // Frames from root to leaf separated by ';'
+    void PrintStack(IOutputStream& output, void* const* stack, size_t depth) const {
+        for (size_t i = depth; i > 0; --i) {
+            const auto& names = Frames.at(stack[i - 1]);
+            if (names.empty()) {
+                output << ';' << stack[i - 1];
+                continue;
+            }
+            for (auto it = names.rbegin(); it != names.rend(); ++it) {
+                output << ';' << (it->empty() ? TStringBuf("??") : TStringBuf(*it));
+            }
+        }
+    }
+
+private:
+    THashMap<void*, std::vector<TString>> Frames;
+};
+
+void WriteCollapsedStacks(IOutputStream& output, const std::map<TString, ui64>& stacks) {
+    for (const auto& [stack, weight] : stacks) {
+        output << stack << ' ' << weight << '\n';
+    }
+    output.Flush();
+}
+
+}  // anonymous namespace
+
+class TSamplingProfiler::TImpl {
+public:
+    explicit TImpl(const TSettings& settings)
+        : Settings(settings)
+    {
+        if (Settings.CpuProfileOutput && !Settings.Frequency) {
+            ythrow yexception() << "Profiler frequency should be positive";
+        }
+        // Without tcmalloc allocation profile is silently empty, extension properties are available only with tcmalloc
+        if (Settings.HeapProfileOutput && !tcmalloc::MallocExtension::GetNumericProperty("generic.current_allocated_bytes")) {
+            ythrow yexception() << "Heap profiler requires tcmalloc allocator, binary is built with other one";
+        }
+    }
+
+    ~TImpl() {
+        if (Running) {
+            try {
+                Stop();
+            } catch (...) {
+                Cerr << "Failed to stop profiler, reason: " << CurrentExceptionMessage() << Endl;
+            }
+        }
+    }
+
+    void Start() {
+        Y_ABORT_UNLESS(!Running);
+
+        if (Settings.HeapProfileOutput) {
+            HeapProfilingToken.emplace(tcmalloc::MallocExtension::StartAllocationProfiling());
+        }
+        if (Settings.CpuProfileOutput) {
+            try {
+                StartCpuProfiling();
+            } catch (...) {
+                // Allocation profiling is stopped by token destructor without collecting profile
+                HeapProfilingToken.reset();
+                throw;
+            }
+        }
+
+        Running = true;
+    }
+
+    void Stop() {
+        Y_ABORT_UNLESS(Running);
+        Running = false;
+
+        if (Settings.CpuProfileOutput) {
+            StopCpuProfiling();
+        }
+        if (HeapProfilingToken) {
+            StopHeapProfiling();
+        }
+    }
+
+private:
+    void StartCpuProfiling() {
+        auto cpuSampler = MakeHolder<TCpuSampler>();
+
+        TCpuSampler* expected = nullptr;
+        if (!ActiveSampler.compare_exchange_strong(expected, cpuSampler.Get())) {
+            ythrow yexception() << "CPU profiler is already running";
+        }
+        // Releases sampler slot if profiling was not started, so that next profiler can be started
+        TActiveSamplerGuard samplerGuard;
+
+        ProfiledProcess = getpid();
+        uintptr_t probe[2] = {};
+        if (!ReadFrame(reinterpret_cast<uintptr_t>(&probe), probe)) {
+            ythrow TSystemError() << "CPU profiler requires process_vm_readv to read stack frames";
+        }
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = &ProfilingSignalHandler;
+        action.sa_flags = SA_RESTART | SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) {
+            ythrow TSystemError() << "Failed to set SIGPROF handler";
+        }
+
+        const suseconds_t intervalUs = 1'000'000 / Settings.Frequency;
+        itimerval timer = {
+            .it_interval = {.tv_sec = intervalUs / 1'000'000, .tv_usec = intervalUs % 1'000'000},
+            .it_value = {.tv_sec = intervalUs / 1'000'000, .tv_usec = intervalUs % 1'000'000}
+        };
+        if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+            ythrow TSystemError() << "Failed to start profiling timer";
+        }
+
+        samplerGuard.Release();
+        CpuSampler = std::move(cpuSampler);
+    }
+
+    void StopCpuProfiling() {
+        itimerval timer = {};
+        setitimer(ITIMER_PROF, &timer, nullptr);
+        ActiveSampler.store(nullptr);
+        // Handlers which loaded sampler before reset may still write samples
+        WaitSignalHandlers();
+
+        const size_t numberSamples = CpuSampler->GetNumberSamples();
+
+        TSymbolizer symbolizer;
+        for (size_t i = 0; i < numberSamples; ++i) {
+            const auto& sample = CpuSampler->GetSample(i);
+            symbolizer.AddStack(sample.Stack, sample.Depth);
+        }
+        symbolizer.Resolve();
+
+        std::map<TString, ui64> stacks;
+        for (size_t i = 0; i < numberSamples; ++i) {
+            const auto& sample = CpuSampler->GetSample(i);
+            TStringBuilder stack;
+            stack << sample.ThreadName;
+            symbolizer.PrintStack(stack.Out, sample.Stack, sample.Depth);
+            stacks[stack]++;
+        }
+        WriteCollapsedStacks(*Settings.CpuProfileOutput, stacks);
+
+        NColorizer::TColors colors = NColorizer::AutoColors(Cout);
+        Cout << colors.Cyan() << "CPU profile collected, samples: " << numberSamples << ", dropped: " << CpuSampler->GetNumberDropped() << colors.Default() << Endl;
+        CpuSampler.Reset();
+    }
+
+    void StopHeapProfiling() {
+        const tcmalloc::Profile profile = std::move(*HeapProfilingToken).Stop();
+        HeapProfilingToken.reset();
+
+        TSymbolizer symbolizer;
+        profile.Iterate([&](const tcmalloc::Profile::Sample& sample) {
+            symbolizer.AddStack(sample.stack, sample.depth);
+        });
+        symbolizer.Resolve();
+
+        std::map<TString, ui64> stacks;
+        profile.Iterate([&](const tcmalloc::Profile::Sample& sample) {
+            TStringBuilder stack;
+            stack << "heap";
+            symbolizer.PrintStack(stack.Out, sample.stack, sample.depth);
+            stacks[stack] += sample.sum;
+        });
+        WriteCollapsedStacks(*Settings.HeapProfileOutput, stacks);
+    }
+
+private:
+    const TSettings Settings;
+    bool Running = false;
+
+    THolder<TCpuSampler> CpuSampler;
+
+    std::optional<tcmalloc::MallocExtension::AllocationProfilingToken> HeapProfilingToken;
+};
+
+TSamplingProfiler::TSamplingProfiler(const TSettings& settings)
+    : Impl(MakeHolder<TImpl>(settings))
+{}
+
+TSamplingProfiler::~TSamplingProfiler() = default;
+
+void TSamplingProfiler::Start() {
+    Impl->Start();
+}
+
+void TSamplingProfiler::Stop() {
+    Impl->Stop();
+}
+
+}  // namespace NKqpRun
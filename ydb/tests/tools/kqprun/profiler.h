@@ -0,0 +1,32 @@
+#pragma once
+
+#include <util/generic/ptr.h>
+#include <util/stream/output.h>
+
+
+namespace NKqpRun {
+
+// In process profiler for kqprun measured loop, profiles are written in collapsed stacks format
+// (input of flamegraph.pl), CPU samples are prefixed with name of sampled thread
+class TSamplingProfiler {
+public:
+    struct TSettings {
+        // Number of samples per second of process CPU time
+        ui32 Frequency = 100;
+        IOutputStream* CpuProfileOutput = nullptr;
+        // Sampled allocations made while profiler is running, requires tcmalloc allocator
+        IOutputStream* HeapProfileOutput = nullptr;
+    };
+
+    explicit TSamplingProfiler(const TSettings& settings);
+    ~TSamplingProfiler();
+
+    void Start();
+    void Stop();
+
+private:
+    class TImpl;
+    THolder<TImpl> Impl;
+};
+
+}  // namespace NKqpRun
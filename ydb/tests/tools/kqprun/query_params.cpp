@@ -0,0 +1,181 @@
+#include "query_params.h"
+
+#include <library/cpp/string_utils/csv/csv.h>
+
+#include <util/generic/yexception.h>
+#include <util/stream/file.h>
+#include <util/string/cast.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace NKqpRun {
+
+namespace {
+
+class TSequentialGenerator : public IParamGenerator {
+public:
+    explicit TSequentialGenerator(i64 start)
+        : Value(start)
+    {}
+
+    TString Next(TFastRng64&) override {
+        return ToString(Value++);
+    }
+
+private:
+    i64 Value;
+};
+
+class TUniformGenerator : public IParamGenerator {
+public:
+    TUniformGenerator(i64 min, i64 max)
+        : Min(min)
+        , Range(max - min + 1)
+    {
+        if (max < min) {
+            ythrow yexception() << "Uniform generator max value " << max << " is less than min value " << min;
+        }
+    }
+
+    TString Next(TFastRng64& rng) override {
+        return ToString(Min + static_cast<i64>(rng.Uniform(Range)));
+    }
+
+private:
+    const i64 Min;
+    const ui64 Range;
+};
+
+// Zipfian generator from "Quickly Generating Billion-Record Synthetic Databases", J. Gray et al.
+class TZipfianGenerator : public IParamGenerator {
+public:
+    TZipfianGenerator(ui64 count, double theta)
+        : Count(count)
+        , Theta(theta)
+    {
+        if (!count) {
+            ythrow yexception() << "Zipfian generator count should be positive";
+        }
+        if (theta <= 0.0 || theta >= 1.0) {
+            ythrow yexception() << "Zipfian generator theta should be in (0, 1), got " << theta;
+        }
+
+        double zetaN = 0.0;
+        for (ui64 i = 1; i <= count; ++i) {
+            zetaN += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        const double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+
+        ZetaN = zetaN;
+        Alpha = 1.0 / (1.0 - theta);
+        Eta = (1.0 - std::pow(2.0 / count, 1.0 - theta)) / (1.0 - zeta2 / zetaN);
+    }
+
+    TString Next(TFastRng64& rng) override {
+        const double u = rng.GenRandReal1();
+        const double uz = u * ZetaN;
+        if (uz < 1.0) {
+            return ToString(0);
+        }
+        if (uz < 1.0 + std::pow(0.5, Theta)) {
+            return ToString(std::min<ui64>(1, Count - 1));
+        }
+        const ui64 value = static_cast<ui64>(Count * std::pow(Eta * u - Eta + 1.0, Alpha));
+        return ToString(std::min(value, Count - 1));
+    }
+
+private:
+    const ui64 Count;
+    const double Theta;
+    double ZetaN = 0.0;
+    double Alpha = 0.0;
+    double Eta = 0.0;
+};
+
+class TCsvColumnGenerator : public IParamGenerator {
+public:
+    TCsvColumnGenerator(const TString& column, const TString& file) {
+        TFileInput input(file);
+
+        TString line;
+        if (!input.ReadLine(line)) {
+            ythrow yexception() << "Csv file " << file << " is empty";
+        }
+        const std::vector<TString> header = SplitLine(line);
+
+        size_t columnId = 0;
+        if (const auto it = std::find(header.begin(), header.end(), column); it != header.end()) {
+            columnId = it - header.begin();
+        } else if (!TryFromString(column, columnId) || columnId >= header.size()) {
+            ythrow yexception() << "Csv file " << file << " has no column " << column;
+        }
+
+        while (input.ReadLine(line)) {
+            if (!line) {
+                continue;
+            }
+            std::vector<TString> fields = SplitLine(line);
+            if (columnId >= fields.size()) {
+                ythrow yexception() << "Csv file " << file << " has row with " << fields.size() << " columns, expected at least " << columnId + 1;
+            }
+            Values.emplace_back(std::move(fields[columnId]));
+        }
+        if (Values.empty()) {
+            ythrow yexception() << "Csv file " << file << " has no rows";
+        }
+    }
+
+    TString Next(TFastRng64& rng) override {
+        return Values[rng.Uniform(Values.size())];
+    }
+
+private:
+    static std::vector<TString> SplitLine(TString& line) {
+        std::vector<TString> fields;
+        NCsvFormat::CsvSplitter splitter(line);
+        do {
+            fields.emplace_back(splitter.Consume());
+        } while (splitter.Step());
+        return fields;
+    }
+
+private:
+    std::vector<TString> Values;
+};
+
+}  // anonymous namespace
+
+IParamGenerator::TPtr CreateParamGenerator(const TString& specification) {
+    TStringBuf type;
+    TStringBuf arguments;
+    if (!TStringBuf(specification).TrySplit(':', type, arguments)) {
+        ythrow yexception() << "Incorrect parameter generator " << specification << ", expected form type:arguments";
+    }
+
+    if (type == "seq") {
+        return MakeHolder<TSequentialGenerator>(FromString<i64>(arguments));
+    }
+    if (type == "uniform") {
+        TStringBuf min, max;
+        arguments.Split(':', min, max);
+        return MakeHolder<TUniformGenerator>(FromString<i64>(min), FromString<i64>(max));
+    }
+    if (type == "zipf") {
+        TStringBuf count, theta;
+        arguments.Split(':', count, theta);
+        return MakeHolder<TZipfianGenerator>(FromString<ui64>(count), FromString<double>(theta));
+    }
+    if (type == "csv") {
+        TStringBuf column, file;
+        if (!arguments.TrySplit(':', column, file)) {
+            ythrow yexception() << "Incorrect csv parameter generator " << specification << ", expected form csv:column:file";
+        }
+        return MakeHolder<TCsvColumnGenerator>(TString(column), TString(file));
+    }
+    ythrow yexception() << "Unknown parameter generator type " << type << ", expected one of seq, uniform, zipf, csv";
+}
+
+}  // namespace NKqpRun
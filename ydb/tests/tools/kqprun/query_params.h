@@ -0,0 +1,26 @@
+#pragma once
+
+#include <util/generic/ptr.h>
+#include <util/generic/string.h>
+#include <util/random/fast.h>
+
+
+namespace NKqpRun {
+
+class IParamGenerator {
+public:
+    using TPtr = THolder<IParamGenerator>;
+
+    virtual ~IParamGenerator() = default;
+
+    virtual TString Next(TFastRng64& rng) = 0;
+};
+
+// Makes generator by specification:
+//   seq:start                 -- start, start + 1, ...
+//   uniform:min:max           -- uniformly distributed integers from [min, max]
+//   zipf:count:theta          -- integers from [0, count) with zipfian distribution, theta in (0, 1)
+//   csv:column:file           -- uniformly chosen values of csv column (name from header or index)
+IParamGenerator::TPtr CreateParamGenerator(const TString& specification);
+
+}  // namespace NKqpRun
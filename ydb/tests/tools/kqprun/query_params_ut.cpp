@@ -0,0 +1,93 @@
+#include "query_params.h"
+
+#include <library/cpp/testing/unittest/registar.h>
+
+#include <util/stream/file.h>
+#include <util/string/cast.h>
+#include <util/system/tempfile.h>
+
+#include <set>
+
+
+namespace NKqpRun {
+
+namespace {
+
+std::vector<ui64> GetValues(const TString& specification, size_t count) {
+    TFastRng64 rng(42);
+    auto generator = CreateParamGenerator(specification);
+    std::vector<ui64> values;
+    for (size_t i = 0; i < count; ++i) {
+        values.emplace_back(FromString<ui64>(generator->Next(rng)));
+    }
+    return values;
+}
+
+}  // anonymous namespace
+
+Y_UNIT_TEST_SUITE(ParamGenerators) {
+    Y_UNIT_TEST(Sequential) {
+        TFastRng64 rng(42);
+        auto generator = CreateParamGenerator("seq:-1");
+        UNIT_ASSERT_VALUES_EQUAL(generator->Next(rng), "-1");
+        UNIT_ASSERT_VALUES_EQUAL(generator->Next(rng), "0");
+        UNIT_ASSERT_VALUES_EQUAL(generator->Next(rng), "1");
+    }
+
+    Y_UNIT_TEST(Uniform) {
+        std::vector<ui64> counts(3, 0);
+        for (const ui64 value : GetValues("uniform:3:5", 3000)) {
+            UNIT_ASSERT_C(value >= 3 && value <= 5, "value " << value);
+            counts[value - 3]++;
+        }
+        for (const ui64 count : counts) {
+            UNIT_ASSERT_C(count > 800 && count < 1200, "count " << count);
+        }
+
+        for (const ui64 value : GetValues("uniform:7:7", 10)) {
+            UNIT_ASSERT_VALUES_EQUAL(value, 7);
+        }
+    }
+
+    Y_UNIT_TEST(Zipfian) {
+        const ui64 count = 100;
+        std::vector<ui64> counts(count, 0);
+        for (const ui64 value : GetValues("zipf:100:0.9", 10000)) {
+            UNIT_ASSERT_C(value < count, "value " << value);
+            counts[value]++;
+        }
+        // Probability of value i is proportional to 1 / (i + 1)^theta
+        UNIT_ASSERT_C(counts[0] > counts[1] && counts[1] > counts[10] && counts[10] > counts[99], "counts " << counts[0] << ", " << counts[1] << ", " << counts[10] << ", " << counts[99]);
+        UNIT_ASSERT_C(counts[0] > 1000, "count " << counts[0]);
+    }
+
+    Y_UNIT_TEST(Csv) {
+        TTempFile file(MakeTempName());
+        TFileOutput(file.Name()).Write("id,name\n1,first\n2,\"second, quoted\"\n");
+
+        TFastRng64 rng(42);
+        std::set<TString> names;
+        std::set<TString> ids;
+        auto nameGenerator = CreateParamGenerator("csv:name:" + file.Name());
+        auto idGenerator = CreateParamGenerator("csv:0:" + file.Name());
+        for (size_t i = 0; i < 100; ++i) {
+            names.emplace(nameGenerator->Next(rng));
+            ids.emplace(idGenerator->Next(rng));
+        }
+        UNIT_ASSERT_EQUAL(names, std::set<TString>({"first", "second, quoted"}));
+        UNIT_ASSERT_EQUAL(ids, std::set<TString>({"1", "2"}));
+
+        UNIT_ASSERT_EXCEPTION_CONTAINS(CreateParamGenerator("csv:value:" + file.Name()), yexception, "has no column value");
+    }
+
+    Y_UNIT_TEST(InvalidSpecification) {
+        UNIT_ASSERT_EXCEPTION_CONTAINS(CreateParamGenerator("seq"), yexception, "expected form type:arguments");
+        UNIT_ASSERT_EXCEPTION_CONTAINS(CreateParamGenerator("normal:1:2"), yexception, "Unknown parameter generator type normal");
+        UNIT_ASSERT_EXCEPTION_CONTAINS(CreateParamGenerator("uniform:5:3"), yexception, "is less than min value");
+        UNIT_ASSERT_EXCEPTION_CONTAINS(CreateParamGenerator("zipf:0:0.5"), yexception, "count should be positive");
+        UNIT_ASSERT_EXCEPTION_CONTAINS(CreateParamGenerator("zipf:10:1"), yexception, "theta should be in (0, 1)");
+        UNIT_ASSERT_EXCEPTION_CONTAINS(CreateParamGenerator("csv:name"), yexception, "expected form csv:column:file");
+    }
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,167 @@
+#include "query_trace.h"
+
+#include <library/cpp/colorizer/colors.h>
+#include <library/cpp/json/json_writer.h>
+
+#include <util/string/printf.h>
+
+#include <algorithm>
+
+
+namespace NKqpRun {
+
+namespace {
+
+// Query index is used as pid, zero pid is not displayed by some viewers
+size_t GetPid(size_t index) {
+    return index + 1;
+}
+
+NJson::TJsonValue CreateEvent(const TString& name, const TString& phase, size_t pid, ui64 tid) {
+    NJson::TJsonValue event(NJson::JSON_MAP);
+    event["name"] = name;
+    event["ph"] = phase;
+    event["pid"] = pid;
+    event["tid"] = tid;
+    return event;
+}
+
+TString FormatMs(TDuration duration) {
+    return Sprintf("%.3f", duration.MicroSeconds() / 1000.0);
+}
+
+}  // anonymous namespace
+
+TQueryTrace::TQueryTrace(IOutputStream* output)
+    : Output(output)
+    , TraceStartTime(TInstant::Now())
+{
+    Y_ABORT_UNLESS(Output);
+    *Output << "[";
+}
+
+TQueryTrace::~TQueryTrace() {
+    try {
+        *Output << "\n]" << Endl;
+    } catch (...) {
+        Cerr << "Failed to finish query trace, reason: " << CurrentExceptionMessage() << Endl;
+    }
+}
+
+void TQueryTrace::StartRun(const std::vector<TString>& queryNames) {
+    QueryNames = queryNames;
+    Stages.clear();
+
+    for (size_t i = 0; i < QueryNames.size(); ++i) {
+        auto event = CreateEvent("process_name", "M", GetPid(i), 0);
+        event["args"]["name"] = QueryNames[i];
+        WriteEvent(event);
+        WriteThreadName(GetPid(i), 0, "executions");
+    }
+}
+
+void TQueryTrace::AddQuery(size_t index, size_t iteration, TInstant startTime, TDuration duration, const std::vector<TStageStats>& stages, const std::optional<TCompilationStats>& compilation) {
+    Y_ABORT_UNLESS(index < QueryNames.size());
+    const size_t pid = GetPid(index);
+    const ui64 timestamp = GetTimestamp(startTime);
+
+    auto queryEvent = CreateEvent(QueryNames[index], "X", pid, 0);
+    queryEvent["ts"] = timestamp;
+    queryEvent["dur"] = duration.MicroSeconds();
+    queryEvent["args"]["iteration"] = iteration;
+    if (compilation) {
+        queryEvent["args"]["compile_from_cache"] = compilation->FromCache;
+        queryEvent["args"]["compile_us"] = compilation->Duration.MicroSeconds();
+    }
+    WriteEvent(queryEvent);
+
+    for (const auto& stage : stages) {
+        WriteThreadName(pid, stage.PlanNodeId, stage.Name);
+
+        auto stageEvent = CreateEvent(stage.Name, "X", pid, stage.PlanNodeId);
+        stageEvent["ts"] = timestamp;
+        stageEvent["dur"] = std::min(stage.Duration, duration).MicroSeconds();
+        auto& args = stageEvent["args"];
+        args["iteration"] = iteration;
+        args["tasks"] = stage.Tasks;
+        args["cpu_us"] = stage.CpuTime.MicroSeconds();
+        args["wait_input_us"] = stage.WaitInputTime.MicroSeconds();
+        args["wait_output_us"] = stage.WaitOutputTime.MicroSeconds();
+        args["output_rows"] = stage.OutputRows;
+        args["input_channel_bytes"] = stage.InputChannelBytes;
+        args["output_channel_bytes"] = stage.OutputChannelBytes;
+        args["spilling_bytes"] = stage.SpillingBytes;
+        args["spilling_us"] = stage.SpillingTime.MicroSeconds();
+        args["max_memory_usage"] = stage.MaxMemoryUsage;
+        WriteEvent(stageEvent);
+
+        auto& aggregate = Stages[{index, stage.PlanNodeId}];
+        aggregate.Name = stage.Name;
+        aggregate.Executions++;
+        aggregate.Duration += stage.Duration;
+        aggregate.CpuTime += stage.CpuTime;
+        aggregate.WaitInputTime += stage.WaitInputTime;
+        aggregate.WaitOutputTime += stage.WaitOutputTime;
+        aggregate.ChannelBytes += stage.InputChannelBytes + stage.OutputChannelBytes;
+        aggregate.SpillingBytes += stage.SpillingBytes;
+    }
+    Output->Flush();
+}
+
+void TQueryTrace::PrintSummary(IOutputStream& output) const {
+    NColorizer::TColors colors = NColorizer::AutoColors(output);
+
+    output << colors.Cyan() << "Query stages statistics, sorted by cpu time (ms):" << colors.Default() << Endl;
+    if (Stages.empty()) {
+        output << "  no stage statistics, query plans are not available" << Endl;
+        return;
+    }
+
+    for (size_t i = 0; i < QueryNames.size(); ++i) {
+        std::vector<const TStageAggregate*> stages;
+        for (auto it = Stages.lower_bound({i, 0}); it != Stages.end() && it->first.first == i; ++it) {
+            stages.emplace_back(&it->second);
+        }
+        if (stages.empty()) {
+            continue;
+        }
+        std::sort(stages.begin(), stages.end(), [](const TStageAggregate* left, const TStageAggregate* right) {
+            return left->CpuTime > right->CpuTime;
+        });
+
+        output << "  " << QueryNames[i] << ":" << Endl;
+        for (const auto* stage : stages) {
+            // Tasks which wait for channels longer than compute are limited by neighbour stages
+            const bool computeBound = stage->CpuTime >= stage->WaitInputTime + stage->WaitOutputTime;
+            output << "    " << stage->Name
+                << ": executions " << stage->Executions
+                << ", cpu " << FormatMs(stage->CpuTime)
+                << ", wait input " << FormatMs(stage->WaitInputTime)
+                << ", wait output " << FormatMs(stage->WaitOutputTime)
+                << ", channel bytes " << stage->ChannelBytes
+                << ", spilling bytes " << stage->SpillingBytes
+                << ", " << (computeBound ? "compute" : "channel") << " bound" << Endl;
+        }
+    }
+}
+
+void TQueryTrace::WriteEvent(const NJson::TJsonValue& event) {
+    *Output << (HasEvents ? ",\n" : "\n");
+    NJson::WriteJson(Output, &event, false);
+    HasEvents = true;
+}
+
+void TQueryTrace::WriteThreadName(size_t pid, ui64 tid, const TString& name) {
+    if (!NamedThreads.emplace(pid, tid).second) {
+        return;
+    }
+    auto event = CreateEvent("thread_name", "M", pid, tid);
+    event["args"]["name"] = name;
+    WriteEvent(event);
+}
+
+ui64 TQueryTrace::GetTimestamp(TInstant time) const {
+    return time > TraceStartTime ? (time - TraceStartTime).MicroSeconds() : 0;
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "plan_stats.h"
+
+#include <util/datetime/base.h>
+#include <util/generic/hash_set.h>
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+
+#include <map>
+#include <optional>
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Writes -p query executions and their plan stages in Chrome trace event format
+// (chrome://tracing, ui.perfetto.dev). Each query is shown as separate process,
+// executions are on thread 0 and stages on thread with stage plan node id.
+// Plan does not contain stage start times, so stages are aligned to query start
+class TQueryTrace {
+public:
+    explicit TQueryTrace(IOutputStream* output);
+    ~TQueryTrace();
+
+    // Resets stage statistics aggregated over executions
+    void StartRun(const std::vector<TString>& queryNames);
+    void AddQuery(size_t index, size_t iteration, TInstant startTime, TDuration duration, const std::vector<TStageStats>& stages, const std::optional<TCompilationStats>& compilation);
+
+    void PrintSummary(IOutputStream& output) const;
+
+private:
+    struct TStageAggregate {
+        TString Name;
+        ui64 Executions = 0;
+        TDuration Duration;
+        TDuration CpuTime;
+        TDuration WaitInputTime;
+        TDuration WaitOutputTime;
+        ui64 ChannelBytes = 0;
+        ui64 SpillingBytes = 0;
+    };
+
+    void WriteEvent(const NJson::TJsonValue& event);
+    void WriteThreadName(size_t pid, ui64 tid, const TString& name);
+    ui64 GetTimestamp(TInstant time) const;
+
+private:
+    IOutputStream* Output;
+    const TInstant TraceStartTime;
+    bool HasEvents = false;
+    THashSet<std::pair<size_t, ui64>> NamedThreads;
+
+    std::vector<TString> QueryNames;
+    std::map<std::pair<size_t, ui64>, TStageAggregate> Stages;
+};
+
+}  // namespace NKqpRun
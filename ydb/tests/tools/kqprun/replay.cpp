@@ -0,0 +1,235 @@
+#include "replay.h"
+
+#include <library/cpp/colorizer/colors.h>
+#include <library/cpp/json/json_reader.h>
+
+#include <util/generic/yexception.h>
+#include <util/stream/file.h>
+#include <util/string/builder.h>
+#include <util/string/printf.h>
+#include <util/string/subst.h>
+
+#include <algorithm>
+
+
+namespace NKqpRun {
+
+namespace {
+
+TString GetOptionalString(const NJson::TJsonValue& line, const TString& key) {
+    const NJson::TJsonValue* value = nullptr;
+    if (!line.GetValuePointer(key, &value)) {
+        return "";
+    }
+    if (!value->IsString()) {
+        ythrow yexception() << "Replay log field " << key << " should be string";
+    }
+    return value->GetString();
+}
+
+TInstant ParseTimestamp(const NJson::TJsonValue& timestamp) {
+    if (timestamp.IsString()) {
+        return TInstant::ParseIso8601(timestamp.GetString());
+    }
+    if (timestamp.IsUInteger()) {
+        return TInstant::MicroSeconds(timestamp.GetUInteger());
+    }
+    ythrow yexception() << "Replay log timestamp should be iso8601 string or number of microseconds";
+}
+
+// Params are inlined into query text, so strings are quoted and escaped, other values are taken as is
+TString ToSqlLiteral(const TString& name, const NJson::TJsonValue& value) {
+    switch (value.GetType()) {
+        case NJson::JSON_STRING: {
+            TStringBuilder literal;
+            literal << '\'';
+            for (const char c : value.GetString()) {
+                if (c == '\'' || c == '\\') {
+                    literal << '\\' << c;
+                } else if (c == '\n') {
+                    literal << "\\n";
+                } else if (c == '\r') {
+                    literal << "\\r";
+                } else if (c == '\t') {
+                    literal << "\\t";
+                } else if (c == '\0') {
+                    literal << "\\x00";
+                } else {
+                    literal << c;
+                }
+            }
+            literal << '\'';
+            return literal;
+        }
+        case NJson::JSON_BOOLEAN:
+        case NJson::JSON_INTEGER:
+        case NJson::JSON_UINTEGER:
+        case NJson::JSON_DOUBLE:
+            return value.GetStringRobust();
+        default:
+            ythrow yexception() << "param " << name << " should be string, number or boolean";
+    }
+}
+
+TString FormatMs(double durationUs) {
+    return Sprintf("%.3f", durationUs / 1000.0);
+}
+
+}  // anonymous namespace
+
+std::vector<TReplayRecord> LoadReplayLog(const TString& file) {
+    TFileInput input(file);
+    THashMap<TString, TString> queriesByHash;
+    std::vector<TReplayRecord> records;
+
+    TString line;
+    for (size_t lineNumber = 1; input.ReadLine(line); ++lineNumber) {
+        if (!line) {
+            continue;
+        }
+
+        try {
+            NJson::TJsonValue json;
+            if (!NJson::ReadJsonTree(line, &json) || !json.IsMap()) {
+                ythrow yexception() << "expected json map";
+            }
+
+            TReplayRecord record = {
+                .Query = GetOptionalString(json, "query"),
+                .QueryHash = GetOptionalString(json, "query_hash"),
+                .Database = GetOptionalString(json, "database"),
+                .UserSID = GetOptionalString(json, "user"),
+                .PoolId = GetOptionalString(json, "pool"),
+                .TraceId = GetOptionalString(json, "trace_id")
+            };
+
+            if (record.Query && record.QueryHash) {
+                queriesByHash[record.QueryHash] = record.Query;
+            } else if (record.QueryHash) {
+                const auto it = queriesByHash.find(record.QueryHash);
+                if (it == queriesByHash.end()) {
+                    ythrow yexception() << "query text for hash " << record.QueryHash << " is not found in previous lines";
+                }
+                record.Query = it->second;
+            } else if (record.Query) {
+                record.QueryHash = ToString(THash<TString>()(record.Query));
+            } else {
+                ythrow yexception() << "expected query text or query_hash";
+            }
+
+            if (json.Has("params")) {
+                if (!json["params"].IsMap()) {
+                    ythrow yexception() << "params should be map";
+                }
+                for (const auto& [name, value] : json["params"].GetMap()) {
+                    SubstGlobal(record.Query, TStringBuilder() << "${" << name << "}", ToSqlLiteral(name, value));
+                }
+            }
+
+            if (!json.Has("timestamp")) {
+                ythrow yexception() << "expected timestamp";
+            }
+            record.Timestamp = ParseTimestamp(json["timestamp"]);
+            if (json.Has("latency_us")) {
+                record.Latency = TDuration::MicroSeconds(json["latency_us"].GetUIntegerRobust());
+            }
+
+            records.emplace_back(std::move(record));
+        } catch (...) {
+            ythrow yexception() << "Failed to parse replay log " << file << " line " << lineNumber << ", reason: " << CurrentExceptionMessage();
+        }
+    }
+
+    if (records.empty()) {
+        ythrow yexception() << "Replay log " << file << " has no queries";
+    }
+    std::stable_sort(records.begin(), records.end(), [](const TReplayRecord& lhs, const TReplayRecord& rhs) {
+        return lhs.Timestamp < rhs.Timestamp;
+    });
+    return records;
+}
+
+void TReplayReport::StartRun(TInstant startTime) {
+    StartTime = startTime;
+}
+
+void TReplayReport::FinishRun(TInstant finishTime) {
+    FinishTime = finishTime;
+}
+
+void TReplayReport::RecordLag(TDuration lag) {
+    Lags.Record(lag);
+}
+
+void TReplayReport::RecordQuery(const TReplayRecord& record, std::optional<TDuration> latency, bool success) {
+    auto& stats = Queries[record.QueryHash];
+    stats.Submitted++;
+    if (!success) {
+        stats.Failed++;
+        return;
+    }
+
+    if (record.Latency) {
+        stats.Recorded.Record(*record.Latency);
+    }
+    if (latency) {
+        stats.Replayed.Record(*latency);
+    }
+    if (record.Latency && latency) {
+        stats.DiffSumUs += static_cast<double>(latency->MicroSeconds()) - record.Latency->MicroSeconds();
+        stats.Compared++;
+        stats.Slower += *latency > *record.Latency;
+    }
+}
+
+NJson::TJsonValue TReplayReport::ToJson() const {
+    NJson::TJsonValue result;
+    result["duration_us"] = (FinishTime - StartTime).MicroSeconds();
+    result["lag"] = Lags.ToJson();
+
+    auto& queries = result["queries"];
+    queries.SetType(NJson::JSON_ARRAY);
+    for (const auto& [hash, stats] : Queries) {
+        auto& queryJson = queries.AppendValue(NJson::TJsonValue());
+        queryJson["query_hash"] = hash;
+        queryJson["submitted"] = stats.Submitted;
+        queryJson["failed"] = stats.Failed;
+        queryJson["recorded"] = stats.Recorded.ToJson();
+        queryJson["replayed"] = stats.Replayed.ToJson();
+        if (stats.Compared) {
+            queryJson["compared"] = stats.Compared;
+            queryJson["mean_diff_us"] = stats.DiffSumUs / stats.Compared;
+            queryJson["slower_share"] = static_cast<double>(stats.Slower) / stats.Compared;
+        }
+    }
+    return result;
+}
+
+void TReplayReport::PrintSummary(IOutputStream& output) const {
+    NColorizer::TColors colors = NColorizer::AutoColors(output);
+
+    output << colors.Cyan() << "Replay statistics (ms), duration " << FormatMs((FinishTime - StartTime).MicroSeconds())
+        << ", send lag p50 " << FormatMs(Lags.GetPercentile(50.0).MicroSeconds())
+        << ", p99 " << FormatMs(Lags.GetPercentile(99.0).MicroSeconds())
+        << ", max " << FormatMs(Lags.GetMax().MicroSeconds()) << ":" << colors.Default() << Endl;
+
+    for (const auto& [hash, stats] : Queries) {
+        output << "  " << hash << ": submitted " << stats.Submitted << ", failed " << stats.Failed;
+        if (stats.Recorded.GetCount()) {
+            output << ", recorded p50 " << FormatMs(stats.Recorded.GetPercentile(50.0).MicroSeconds())
+                << ", p99 " << FormatMs(stats.Recorded.GetPercentile(99.0).MicroSeconds());
+        }
+        if (stats.Replayed.GetCount()) {
+            output << ", replayed p50 " << FormatMs(stats.Replayed.GetPercentile(50.0).MicroSeconds())
+                << ", p99 " << FormatMs(stats.Replayed.GetPercentile(99.0).MicroSeconds());
+        }
+        if (stats.Compared) {
+            const double meanDiffUs = stats.DiffSumUs / stats.Compared;
+            output << ", mean diff " << (meanDiffUs > 0.0 ? colors.Red() : colors.Green()) << FormatMs(meanDiffUs) << colors.Default();
+        }
+        output << Endl;
+    }
+    output << "  Note: params are inlined into query text and cluster starts with empty compile cache, so compile cache hits differ from original workload" << Endl;
+}
+
+}  // namespace NKqpRun
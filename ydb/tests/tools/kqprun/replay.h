@@ -0,0 +1,76 @@
+#pragma once
+
+#include "latency_stats.h"
+
+#include <library/cpp/json/json_value.h>
+
+#include <util/datetime/base.h>
+#include <util/generic/hash.h>
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+
+#include <map>
+#include <optional>
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Captured query log in json lines format, one query per line:
+//   {"query": "SELECT ...", "query_hash": "q1", "params": {"id": 42, "name": "abc"}, "database": "/Root/db", "user": "root@builtin",
+//    "pool": "default", "trace_id": "...", "timestamp": "2024-01-01T00:00:00.123456Z", "latency_us": 1500}
+// Query text may be omitted if it was given earlier in log with the same query_hash,
+// params are substituted into ${name} templates of query text as SQL literals: strings are quoted and escaped,
+// numbers and booleans are taken as is, timestamp is iso8601 string or microseconds.
+// Inlined params make query text differ for each value, and replay starts with empty compile cache,
+// so compile cache behaviour and compilation time are not the same as in original workload
+struct TReplayRecord {
+    TString Query;
+    TString QueryHash;
+    TString Database;
+    TString UserSID;
+    TString PoolId;
+    TString TraceId;
+    TInstant Timestamp;
+    std::optional<TDuration> Latency;
+};
+
+// Records are sorted by timestamp
+std::vector<TReplayRecord> LoadReplayLog(const TString& file);
+
+// Compares replayed latencies with recorded ones, queries are grouped by query hash
+class TReplayReport {
+public:
+    TReplayReport() = default;
+
+    void StartRun(TInstant startTime);
+    void FinishRun(TInstant finishTime);
+
+    void RecordLag(TDuration lag);
+    // Replayed latency is not known for async queries
+    void RecordQuery(const TReplayRecord& record, std::optional<TDuration> latency, bool success);
+
+    NJson::TJsonValue ToJson() const;
+    void PrintSummary(IOutputStream& output) const;
+
+private:
+    struct TQueryStats {
+        // All sent queries, replayed latencies are measured only for sync ones
+        ui64 Submitted = 0;
+        TLatencyHistogram Recorded;
+        TLatencyHistogram Replayed;
+        // Replayed minus recorded latency, only for queries with both values
+        double DiffSumUs = 0.0;
+        ui64 Compared = 0;
+        ui64 Slower = 0;
+        ui64 Failed = 0;
+    };
+
+private:
+    std::map<TString, TQueryStats> Queries;
+    TLatencyHistogram Lags;
+    TInstant StartTime;
+    TInstant FinishTime;
+};
+
+}  // namespace NKqpRun
@@ -0,0 +1,49 @@
+#include "result_capture.h"
+
+#include <algorithm>
+
+
+namespace NKqpRun {
+
+TResultCapture::TResultCapture(IOutputStream* forward, bool countRows)
+    : Forward(forward)
+    , CountRows(countRows)
+{}
+
+TResultCapture::TResultSize TResultCapture::Measure(const std::function<void()>& print) {
+    Rows = 0;
+    Bytes = 0;
+    Forwarding = false;
+    try {
+        print();
+    } catch (...) {
+        Forwarding = true;
+        throw;
+    }
+    Forwarding = true;
+
+    TResultSize result = {.Bytes = Bytes};
+    if (CountRows) {
+        result.Rows = Rows;
+    }
+    return result;
+}
+
+void TResultCapture::DoWrite(const void* buf, size_t len) {
+    Bytes += len;
+    if (CountRows) {
+        const char* data = static_cast<const char*>(buf);
+        Rows += std::count(data, data + len, '\n');
+    }
+    if (Forwarding && Forward) {
+        Forward->Write(buf, len);
+    }
+}
+
+void TResultCapture::DoFlush() {
+    if (Forwarding && Forward) {
+        Forward->Flush();
+    }
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <util/stream/output.h>
+
+#include <functional>
+#include <optional>
+
+
+namespace NKqpRun {
+
+// Used as script results output of runner, counts size of printed results
+// and forwards them to user result output
+class TResultCapture : public IOutputStream {
+public:
+    struct TResultSize {
+        // Known only for formats with one row per line
+        std::optional<ui64> Rows;
+        ui64 Bytes = 0;
+    };
+
+    TResultCapture(IOutputStream* forward, bool countRows);
+
+    // Output of print is not forwarded, only its size is returned
+    TResultSize Measure(const std::function<void()>& print);
+
+protected:
+    void DoWrite(const void* buf, size_t len) override;
+    void DoFlush() override;
+
+private:
+    IOutputStream* Forward;
+    const bool CountRows;
+    bool Forwarding = true;
+    ui64 Rows = 0;
+    ui64 Bytes = 0;
+};
+
+}  // namespace NKqpRun
@@ -0,0 +1,167 @@
+#include "scenario.h"
+
+#include <library/cpp/yaml/fyamlcpp/fyamlcpp.h>
+
+#include <util/folder/path.h>
+#include <util/generic/yexception.h>
+#include <util/stream/file.h>
+#include <util/string/cast.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+std::optional<TString> GetOptionalScalar(const NKikimr::NFyaml::TMapping& node, const TString& key) {
+    if (!node.Has(key)) {
+        return std::nullopt;
+    }
+    return node.at(key).Scalar();
+}
+
+TScenario::TQuery ParseQuery(const NKikimr::NFyaml::TNodeRef& node, const TFsPath& scenarioDir) {
+    if (node.Type() != NKikimr::NFyaml::ENodeType::Mapping) {
+        ythrow yexception() << "Scenario query should be map";
+    }
+    const auto& map = node.Map();
+
+    const auto queryFile = GetOptionalScalar(map, "query");
+    if (!queryFile) {
+        ythrow yexception() << "Scenario query should have query file";
+    }
+    TFsPath queryPath(*queryFile);
+    if (queryPath.IsRelative()) {
+        queryPath = scenarioDir / queryPath;
+    }
+
+    TScenario::TQuery query = {
+        .Name = GetOptionalScalar(map, "name").value_or(queryPath.GetName()),
+        .Text = TFileInput(queryPath).ReadAll(),
+        .ExecutionCase = GetOptionalScalar(map, "execution_case"),
+        .PoolId = GetOptionalScalar(map, "pool"),
+        .Database = GetOptionalScalar(map, "database"),
+        .UserSID = GetOptionalScalar(map, "user")
+    };
+    if (const auto weight = GetOptionalScalar(map, "weight")) {
+        query.Weight = FromString<ui64>(*weight);
+        if (!query.Weight) {
+            ythrow yexception() << "Scenario query " << query.Name << " should have positive weight";
+        }
+    }
+    if (const auto timeout = GetOptionalScalar(map, "timeout_ms")) {
+        query.Timeout = TDuration::MilliSeconds(FromString<ui64>(*timeout));
+    }
+    return query;
+}
+
+TScenario::TColumn ParseColumn(const NKikimr::NFyaml::TNodeRef& node, const TString& table) {
+    if (node.Type() != NKikimr::NFyaml::ENodeType::Mapping) {
+        ythrow yexception() << "Scenario table " << table << " column should be map";
+    }
+    const auto& map = node.Map();
+
+    TScenario::TColumn column;
+    for (const auto& [key, value] : std::vector<std::pair<TString, TString*>>{{"name", &column.Name}, {"type", &column.Type}, {"generator", &column.Generator}}) {
+        const auto field = GetOptionalScalar(map, key);
+        if (!field) {
+            ythrow yexception() << "Scenario table " << table << " column should have " << key;
+        }
+        *value = *field;
+    }
+    return column;
+}
+
+TScenario::TTable ParseTable(const NKikimr::NFyaml::TNodeRef& node) {
+    if (node.Type() != NKikimr::NFyaml::ENodeType::Mapping) {
+        ythrow yexception() << "Scenario data table should be map";
+    }
+    const auto& map = node.Map();
+
+    const auto path = GetOptionalScalar(map, "table");
+    const auto rows = GetOptionalScalar(map, "rows");
+    if (!path || !rows) {
+        ythrow yexception() << "Scenario data table should have table path and number of rows";
+    }
+
+    TScenario::TTable table = {
+        .Path = *path,
+        .Rows = FromString<ui64>(*rows),
+        .Database = GetOptionalScalar(map, "database")
+    };
+    if (const auto batchSize = GetOptionalScalar(map, "batch_size")) {
+        table.BatchSize = FromString<ui64>(*batchSize);
+        if (!table.BatchSize) {
+            ythrow yexception() << "Scenario table " << table.Path << " should have positive batch size";
+        }
+    }
+
+    if (!map.Has("columns") || map.at("columns").Type() != NKikimr::NFyaml::ENodeType::Sequence) {
+        ythrow yexception() << "Scenario table " << table.Path << " should have columns list";
+    }
+    for (const auto& column : map.at("columns").Sequence()) {
+        table.Columns.emplace_back(ParseColumn(column, table.Path));
+    }
+    if (table.Columns.empty()) {
+        ythrow yexception() << "Scenario table " << table.Path << " has no columns";
+    }
+    return table;
+}
+
+}  // anonymous namespace
+
+TScenario TScenario::Load(const TString& file) {
+    const auto document = NKikimr::NFyaml::TDocument::Parse(TFileInput(file).ReadAll());
+    const auto root = document.Root();
+    if (root.Type() != NKikimr::NFyaml::ENodeType::Mapping || !root.Map().Has("queries")) {
+        ythrow yexception() << "Scenario " << file << " should be map with queries list";
+    }
+
+    const auto queries = root.Map().at("queries");
+    if (queries.Type() != NKikimr::NFyaml::ENodeType::Sequence) {
+        ythrow yexception() << "Scenario queries should be list";
+    }
+
+    TScenario scenario;
+    const TFsPath scenarioDir = TFsPath(file).Parent();
+    for (const auto& query : queries.Sequence()) {
+        scenario.Queries.emplace_back(ParseQuery(query, scenarioDir));
+    }
+    if (scenario.Queries.empty()) {
+        ythrow yexception() << "Scenario " << file << " has no queries";
+    }
+
+    if (root.Map().Has("data")) {
+        const auto data = root.Map().at("data");
+        if (data.Type() != NKikimr::NFyaml::ENodeType::Sequence) {
+            ythrow yexception() << "Scenario data should be list";
+        }
+        for (const auto& table : data.Sequence()) {
+            scenario.Data.emplace_back(ParseTable(table));
+        }
+    }
+    return scenario;
+}
+
+TWeightedRoundRobin::TWeightedRoundRobin(std::vector<ui64> weights)
+    : Weights(std::move(weights))
+    , Current(Weights.size(), 0)
+{
+    Y_ABORT_UNLESS(!Weights.empty());
+    for (const ui64 weight : Weights) {
+        TotalWeight += weight;
+    }
+}
+
+size_t TWeightedRoundRobin::Next() {
+    size_t selected = 0;
+    for (size_t i = 0; i < Weights.size(); ++i) {
+        Current[i] += Weights[i];
+        if (Current[i] > Current[selected]) {
+            selected = i;
+        }
+    }
+    Current[selected] -= TotalWeight;
+    return selected;
+}
+
+}  // namespace NKqpRun
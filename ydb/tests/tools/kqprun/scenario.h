@@ -0,0 +1,76 @@
+#pragma once
+
+#include <util/datetime/base.h>
+#include <util/generic/string.h>
+
+#include <optional>
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Workload description in yaml format:
+//   queries:
+//     - name: point_read          # name in statistics, by default query file name
+//       query: point_read.sql     # path relative to scenario file
+//       weight: 70                # share of query in workload mix, by default 1
+//       execution_case: async     # same values as -C option
+//       pool: default
+//       database: /Root/db
+//       user: root@builtin
+//       timeout_ms: 1000
+//   data:                         # optional, tables are filled one batch at a time after scheme query
+//     - table: /Root/db/lineitem
+//       rows: 1000000
+//       batch_size: 1000          # rows per UPSERT query, by default 1000, larger batches load faster
+//       database: /Root/db
+//       columns:
+//         - name: id
+//           type: Uint64          # any YQL type castable from string
+//           generator: seq:0      # see CreateParamGenerator in query_params.h
+struct TScenario {
+    struct TQuery {
+        TString Name;
+        TString Text;
+        ui64 Weight = 1;
+        std::optional<TString> ExecutionCase;
+        std::optional<TString> PoolId;
+        std::optional<TString> Database;
+        std::optional<TString> UserSID;
+        std::optional<TDuration> Timeout;
+    };
+
+    struct TColumn {
+        TString Name;
+        TString Type;
+        TString Generator;
+    };
+
+    struct TTable {
+        TString Path;
+        ui64 Rows = 0;
+        ui64 BatchSize = 1000;
+        std::optional<TString> Database;
+        std::vector<TColumn> Columns;
+    };
+
+    std::vector<TQuery> Queries;
+    std::vector<TTable> Data;
+
+    static TScenario Load(const TString& file);
+};
+
+// Deterministic smooth weighted round robin, each window of sum(weights) steps follows exact weights
+class TWeightedRoundRobin {
+public:
+    explicit TWeightedRoundRobin(std::vector<ui64> weights);
+
+    size_t Next();
+
+private:
+    const std::vector<ui64> Weights;
+    std::vector<i64> Current;
+    i64 TotalWeight = 0;
+};
+
+}  // namespace NKqpRun
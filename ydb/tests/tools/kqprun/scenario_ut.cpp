@@ -0,0 +1,54 @@
+#include "scenario.h"
+
+#include <library/cpp/testing/unittest/registar.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+std::vector<size_t> GetSequence(TWeightedRoundRobin& roundRobin, size_t length) {
+    std::vector<size_t> sequence;
+    for (size_t i = 0; i < length; ++i) {
+        sequence.emplace_back(roundRobin.Next());
+    }
+    return sequence;
+}
+
+}  // anonymous namespace
+
+Y_UNIT_TEST_SUITE(WeightedRoundRobin) {
+    Y_UNIT_TEST(SmoothSequence) {
+        TWeightedRoundRobin roundRobin({5, 1, 1});
+        const std::vector<size_t> expected = {0, 0, 1, 0, 2, 0, 0};
+        UNIT_ASSERT_EQUAL(GetSequence(roundRobin, 7), expected);
+        UNIT_ASSERT_EQUAL(GetSequence(roundRobin, 7), expected);
+    }
+
+    Y_UNIT_TEST(ExactRatiosInWindow) {
+        const std::vector<ui64> weights = {7, 3, 1, 4};
+        TWeightedRoundRobin roundRobin(weights);
+        for (size_t window = 0; window < 10; ++window) {
+            std::vector<ui64> counts(weights.size(), 0);
+            for (const size_t index : GetSequence(roundRobin, 15)) {
+                UNIT_ASSERT(index < weights.size());
+                counts[index]++;
+            }
+            UNIT_ASSERT_EQUAL_C(counts, weights, "window " << window);
+        }
+    }
+
+    Y_UNIT_TEST(ZeroWeight) {
+        TWeightedRoundRobin roundRobin({2, 0, 1});
+        const std::vector<size_t> expected = {0, 2, 0, 0, 2, 0};
+        UNIT_ASSERT_EQUAL(GetSequence(roundRobin, 6), expected);
+    }
+
+    Y_UNIT_TEST(EqualWeights) {
+        TWeightedRoundRobin roundRobin({1, 1});
+        const std::vector<size_t> expected = {0, 1, 0, 1};
+        UNIT_ASSERT_EQUAL(GetSequence(roundRobin, 4), expected);
+    }
+}
+
+}  // namespace NKqpRun
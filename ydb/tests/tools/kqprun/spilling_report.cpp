@@ -0,0 +1,142 @@
+#include "spilling_report.h"
+
+#include <library/cpp/colorizer/colors.h>
+
+#include <util/folder/iterator.h>
+#include <util/string/printf.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+constexpr TDuration DISK_USAGE_SAMPLING_PERIOD = TDuration::MilliSeconds(100);
+
+// Spilling files are removed concurrently, so missing files are skipped
+ui64 GetDirectorySize(const TString& root) {
+    ui64 size = 0;
+    try {
+        TDirIterator iterator(root);
+        for (const auto& entry : iterator) {
+            if (entry.fts_info == FTS_F && entry.fts_statp) {
+                size += entry.fts_statp->st_size;
+            }
+        }
+    } catch (...) {
+        // Directory is changed during iteration, sample is dropped
+    }
+    return size;
+}
+
+TString FormatMb(ui64 bytes) {
+    return Sprintf("%.1f", bytes / 1048576.0);
+}
+
+// Throughput in MB/s
+TString FormatThroughput(ui64 bytes, TDuration time) {
+    if (!time) {
+        return "-";
+    }
+    return Sprintf("%.1f", bytes / 1048576.0 / time.SecondsFloat());
+}
+
+}  // anonymous namespace
+
+TSpillingReport::TSpillingReport(const TString& spillingRoot)
+    : SpillingRoot(spillingRoot)
+{}
+
+TSpillingReport::~TSpillingReport() {
+    if (DiskUsageSampler) {
+        FinishRun();
+    }
+}
+
+void TSpillingReport::StartRun(const std::vector<TString>& queryNames) {
+    // Previous run could be interrupted by exception before FinishRun
+    FinishRun();
+
+    QueryNames = queryNames;
+    Stages.clear();
+    PeakDiskUsage = 0;
+
+    SamplerStopped.Reset();
+    DiskUsageSampler = MakeHolder<TThread>([this]() {
+        TThread::SetCurrentThreadName("kqprun-spilling");
+        do {
+            SampleDiskUsage();
+        } while (!SamplerStopped.WaitT(DISK_USAGE_SAMPLING_PERIOD));
+    });
+    DiskUsageSampler->Start();
+}
+
+void TSpillingReport::AddQuery(size_t index, const std::vector<TStageStats>& stages) {
+    Y_ABORT_UNLESS(index < QueryNames.size());
+    for (const auto& stage : stages) {
+        if (!stage.SpillingBytes && !stage.SpillingTime) {
+            continue;
+        }
+        auto& spilling = Stages[{index, stage.PlanNodeId}];
+        spilling.Name = stage.Name;
+        spilling.Executions++;
+        spilling.ComputeBytes += stage.SpillingComputeBytes;
+        spilling.ChannelBytes += stage.SpillingChannelBytes;
+        spilling.ComputeTime += stage.SpillingComputeTime;
+        spilling.ChannelTime += stage.SpillingChannelTime;
+    }
+}
+
+void TSpillingReport::FinishRun() {
+    if (!DiskUsageSampler) {
+        return;
+    }
+    SamplerStopped.Signal();
+    DiskUsageSampler->Join();
+    DiskUsageSampler.Reset();
+}
+
+void TSpillingReport::SampleDiskUsage() {
+    const ui64 size = GetDirectorySize(SpillingRoot);
+    ui64 peak = PeakDiskUsage.load();
+    while (size > peak && !PeakDiskUsage.compare_exchange_weak(peak, size)) {
+    }
+}
+
+NJson::TJsonValue TSpillingReport::ToJson() const {
+    NJson::TJsonValue result(NJson::JSON_MAP);
+    result["root"] = SpillingRoot;
+    result["peak_disk_usage_bytes"] = PeakDiskUsage.load();
+
+    auto& stages = result["stages"];
+    stages.SetType(NJson::JSON_ARRAY);
+    for (const auto& [id, stage] : Stages) {
+        auto& stageJson = stages.AppendValue(NJson::TJsonValue(NJson::JSON_MAP));
+        stageJson["query"] = QueryNames[id.first];
+        stageJson["stage"] = stage.Name;
+        stageJson["executions"] = stage.Executions;
+        stageJson["compute_bytes"] = stage.ComputeBytes;
+        stageJson["channel_bytes"] = stage.ChannelBytes;
+        stageJson["compute_time_us"] = stage.ComputeTime.MicroSeconds();
+        stageJson["channel_time_us"] = stage.ChannelTime.MicroSeconds();
+    }
+    return result;
+}
+
+void TSpillingReport::PrintSummary(IOutputStream& output) const {
+    NColorizer::TColors colors = NColorizer::AutoColors(output);
+
+    output << colors.Cyan() << "Spilling statistics (MB, MB/s), peak disk usage " << FormatMb(PeakDiskUsage.load()) << ":" << colors.Default() << Endl;
+    if (Stages.empty()) {
+        output << "  no spilled stages" << Endl;
+        return;
+    }
+    for (const auto& [id, stage] : Stages) {
+        output << "  " << QueryNames[id.first] << " " << stage.Name
+            << ": executions " << stage.Executions
+            << ", compute " << FormatMb(stage.ComputeBytes) << " at " << FormatThroughput(stage.ComputeBytes, stage.ComputeTime)
+            << ", channels " << FormatMb(stage.ChannelBytes) << " at " << FormatThroughput(stage.ChannelBytes, stage.ChannelTime)
+            << ", blocked " << Sprintf("%.3f", (stage.ComputeTime + stage.ChannelTime).MicroSeconds() / 1000.0) << " ms" << Endl;
+    }
+}
+
+}  // namespace NKqpRun
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "plan_stats.h"
+
+#include <library/cpp/json/json_value.h>
+
+#include <util/generic/ptr.h>
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+#include <util/system/event.h>
+#include <util/system/thread.h>
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+
+namespace NKqpRun {
+
+// Spilling statistics of -p queries from plan statistics, summed over loop iterations,
+// and peak size of spilling directory sampled in background during run
+class TSpillingReport {
+public:
+    explicit TSpillingReport(const TString& spillingRoot);
+    ~TSpillingReport();
+
+    void StartRun(const std::vector<TString>& queryNames);
+    void AddQuery(size_t index, const std::vector<TStageStats>& stages);
+    void FinishRun();
+
+    NJson::TJsonValue ToJson() const;
+    void PrintSummary(IOutputStream& output) const;
+
+private:
+    struct TStageSpilling {
+        TString Name;
+        ui64 Executions = 0;
+        ui64 ComputeBytes = 0;
+        ui64 ChannelBytes = 0;
+        TDuration ComputeTime;
+        TDuration ChannelTime;
+    };
+
+    void SampleDiskUsage();
+
+private:
+    const TString SpillingRoot;
+    std::vector<TString> QueryNames;
+    std::map<std::pair<size_t, ui64>, TStageSpilling> Stages;
+
+    THolder<TThread> DiskUsageSampler;
+    TManualEvent SamplerStopped;
+    std::atomic<ui64> PeakDiskUsage = 0;
+};
+
+}  // namespace NKqpRun
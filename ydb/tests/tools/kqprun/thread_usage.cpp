@@ -0,0 +1,213 @@
+#include "thread_usage.h"
+
+#include <library/cpp/colorizer/colors.h>
+
+#include <util/folder/path.h>
+#include <util/stream/file.h>
+#include <util/string/ascii.h>
+#include <util/string/cast.h>
+#include <util/string/printf.h>
+#include <util/string/split.h>
+#include <util/string/strip.h>
+
+#include <algorithm>
+#include <optional>
+
+#include <time.h>
+#include <unistd.h>
+
+
+namespace NKqpRun {
+
+namespace {
+
+constexpr TDuration THREADS_SAMPLING_PERIOD = TDuration::MilliSeconds(100);
+
+// Same clock as thread start times in procfs
+TDuration GetTimeSinceBoot() {
+    timespec time;
+    clock_gettime(CLOCK_BOOTTIME, &time);
+    return TDuration::Seconds(time.tv_sec) + TDuration::MicroSeconds(time.tv_nsec / 1000);
+}
+
+struct TThreadStat {
+    TDuration CpuTime;
+    TDuration StartTime;
+};
+
+TString GetGroupName(TString name) {
+    StripInPlace(name);
+    while (name && (IsAsciiDigit(name.back()) || name.back() == '.' || name.back() == ':' || name.back() == '-' || name.back() == '_')) {
+        name.pop_back();
+    }
+    return name ? name : TString("unnamed");
+}
+
+// Fields utime, stime and starttime from /proc/<pid>/task/<tid>/stat, command name may contain spaces
+std::optional<TThreadStat> ReadThreadStat(const TFsPath& taskDir) {
+    const TString stat = TFileInput(taskDir / "stat").ReadAll();
+    const size_t commandEnd = stat.rfind(')');
+    if (commandEnd == TString::npos) {
+        return std::nullopt;
+    }
+
+    const TVector<TString> fields = StringSplitter(TStringBuf(stat).substr(commandEnd + 2)).Split(' ').ToList<TString>();
+    // Fields after command start from state (3rd field), utime and stime are 14th and 15th, starttime is 22th
+    if (fields.size() < 20) {
+        return std::nullopt;
+    }
+    static const double ticksPerSecond = sysconf(_SC_CLK_TCK);
+    const auto toDuration = [](ui64 ticks) {
+        return TDuration::MicroSeconds(ticks * 1'000'000 / ticksPerSecond);
+    };
+    return TThreadStat{
+        .CpuTime = toDuration(FromString<ui64>(fields[11]) + FromString<ui64>(fields[12])),
+        .StartTime = toDuration(FromString<ui64>(fields[19]))
+    };
+}
+
+}  // anonymous namespace
+
+double TThreadUsage::TGroupUsage::GetUtilization() const {
+    const TDuration total = CpuTime + WallMinusCpuTime;
+    return total ? CpuTime.SecondsFloat() / total.SecondsFloat() : 0.0;
+}
+
+TThreadUsage::~TThreadUsage() {
+    StopSampler();
+}
+
+void TThreadUsage::StartRun() {
+    // Previous run could be interrupted by exception before FinishRun
+    StopSampler();
+
+    RunStartTime = GetTimeSinceBoot();
+    StartThreads = CollectThreads();
+    LastThreads = StartThreads;
+    Groups.clear();
+
+    SamplerStopped.Reset();
+    Sampler = MakeHolder<TThread>([this]() {
+        TThread::SetCurrentThreadName("kqprun-threads");
+        while (!SamplerStopped.WaitT(THREADS_SAMPLING_PERIOD)) {
+            SampleThreads();
+        }
+    });
+    Sampler->Start();
+}
+
+void TThreadUsage::FinishRun() {
+    StopSampler();
+    SampleThreads();
+
+    const TDuration runFinishTime = GetTimeSinceBoot();
+    for (const auto& [tid, thread] : LastThreads) {
+        // Thread is accounted from its start or run start and to its last sample, so finished threads
+        // lose at most one sampling period
+        TDuration cpuTime = thread.CpuTime;
+        TDuration finishTime = runFinishTime;
+        if (thread.LastSeenTime + THREADS_SAMPLING_PERIOD < runFinishTime) {
+            finishTime = thread.LastSeenTime;
+        }
+        const TDuration startTime = std::max(RunStartTime, thread.StartTime);
+        if (const auto it = StartThreads.find(tid); it != StartThreads.end() && it->second.StartTime == thread.StartTime) {
+            cpuTime -= std::min(cpuTime, it->second.CpuTime);
+        }
+        const TDuration lifetime = finishTime - std::min(finishTime, startTime);
+
+        auto& group = Groups[GetGroupName(thread.Name)];
+        group.Threads++;
+        group.FinishedThreads += finishTime != runFinishTime;
+        group.CpuTime += cpuTime;
+        group.WallMinusCpuTime += lifetime - std::min(lifetime, cpuTime);
+    }
+}
+
+void TThreadUsage::SampleThreads() {
+    for (auto& [tid, thread] : CollectThreads()) {
+        // Thread id is reused by new thread, the first thread is kept
+        if (const auto it = LastThreads.find(tid); it != LastThreads.end() && it->second.StartTime != thread.StartTime) {
+            continue;
+        }
+        LastThreads[tid] = std::move(thread);
+    }
+}
+
+void TThreadUsage::StopSampler() {
+    if (!Sampler) {
+        return;
+    }
+    SamplerStopped.Signal();
+    Sampler->Join();
+    Sampler.Reset();
+}
+
+const std::map<TString, TThreadUsage::TGroupUsage>& TThreadUsage::GetGroups() const {
+    return Groups;
+}
+
+NJson::TJsonValue TThreadUsage::ToJson() const {
+    NJson::TJsonValue result(NJson::JSON_MAP);
+    for (const auto& [name, group] : Groups) {
+        auto& groupJson = result[name];
+        groupJson["threads"] = group.Threads;
+        groupJson["finished_threads"] = group.FinishedThreads;
+        groupJson["cpu_us"] = group.CpuTime.MicroSeconds();
+        groupJson["wall_minus_cpu_us"] = group.WallMinusCpuTime.MicroSeconds();
+        groupJson["utilization"] = group.GetUtilization();
+    }
+    return result;
+}
+
+void TThreadUsage::PrintSummary(IOutputStream& output) const {
+    NColorizer::TColors colors = NColorizer::AutoColors(output);
+
+    output << colors.Cyan() << "Threads CPU usage by thread name without numeric suffix:" << colors.Default() << Endl;
+    for (const auto& [name, group] : Groups) {
+        if (!group.CpuTime) {
+            continue;
+        }
+        output << "  " << name
+            << ": threads " << group.Threads;
+        if (group.FinishedThreads) {
+            output << " (finished " << group.FinishedThreads << ")";
+        }
+        output << ", cpu " << Sprintf("%.3f", group.CpuTime.SecondsFloat()) << " s"
+            << ", wall - cpu " << Sprintf("%.3f", group.WallMinusCpuTime.SecondsFloat()) << " s"
+            << ", utilization " << Sprintf("%.1f", group.GetUtilization() * 100) << "%" << Endl;
+    }
+}
+
+THashMap<ui64, TThreadUsage::TThreadInfo> TThreadUsage::CollectThreads() {
+    THashMap<ui64, TThreadInfo> threads;
+
+    TVector<TFsPath> tasks;
+    try {
+        TFsPath("/proc/self/task").List(tasks);
+    } catch (...) {
+        return threads;
+    }
+
+    for (const auto& taskDir : tasks) {
+        ui64 tid = 0;
+        if (!TryFromString(taskDir.GetName(), tid)) {
+            continue;
+        }
+        // Thread may finish while statistics are collected
+        try {
+            if (const auto stat = ReadThreadStat(taskDir)) {
+                threads[tid] = {
+                    .Name = TFileInput(taskDir / "comm").ReadAll(),
+                    .CpuTime = stat->CpuTime,
+                    .StartTime = stat->StartTime,
+                    .LastSeenTime = GetTimeSinceBoot()
+                };
+            }
+        } catch (...) {
+            continue;
+        }
+    }
+    return threads;
+}
+
+}  // namespace NKqpRun
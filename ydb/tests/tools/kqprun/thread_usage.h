@@ -0,0 +1,69 @@
+#pragma once
+
+#include <library/cpp/json/json_value.h>
+
+#include <util/datetime/base.h>
+#include <util/generic/hash.h>
+#include <util/generic/ptr.h>
+#include <util/generic/string.h>
+#include <util/stream/output.h>
+#include <util/system/event.h>
+#include <util/system/thread.h>
+
+#include <map>
+
+
+namespace NKqpRun {
+
+// CPU usage of process threads during run, grouped by thread name without numeric suffix,
+// so each actor system pool is reported as one group. Threads are sampled in background,
+// so threads started or finished during run are accounted over their lifetime in run.
+// Available only on linux (procfs). Reasons of off CPU time (parking, waiting for mailbox,
+// preemption) and harmonizer decisions are not visible here
+class TThreadUsage {
+public:
+    struct TGroupUsage {
+        ui64 Threads = 0;
+        ui64 FinishedThreads = 0;
+        TDuration CpuTime;
+        // Thread lifetime in run minus its CPU time
+        TDuration WallMinusCpuTime;
+
+        double GetUtilization() const;
+    };
+
+    ~TThreadUsage();
+
+    void StartRun();
+    void FinishRun();
+
+    const std::map<TString, TGroupUsage>& GetGroups() const;
+
+    NJson::TJsonValue ToJson() const;
+    void PrintSummary(IOutputStream& output) const;
+
+private:
+    struct TThreadInfo {
+        TString Name;
+        TDuration CpuTime;
+        // Since system boot
+        TDuration StartTime;
+        TDuration LastSeenTime;
+    };
+
+    static THashMap<ui64, TThreadInfo> CollectThreads();
+    void SampleThreads();
+    void StopSampler();
+
+private:
+    TDuration RunStartTime;
+    THashMap<ui64, TThreadInfo> StartThreads;
+    // Last sample of each thread seen during run, written only by sampler thread until it is joined
+    THashMap<ui64, TThreadInfo> LastThreads;
+    std::map<TString, TGroupUsage> Groups;
+
+    THolder<TThread> Sampler;
+    TManualEvent SamplerStopped;
+};
+
+}  // namespace NKqpRun